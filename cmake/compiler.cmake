@@ -45,7 +45,11 @@ if(EXISTS $ENV{ROOTSYS}/cmake/ROOTConfig.cmake)
 else()
   list(APPEND CMAKE_MODULE_PATH $ENV{ROOTSYS}/etc/cmake)
 endif()
-find_package(ROOT COMPONENTS GenVector EG MathMore REQUIRED)
+if (LAGER_RNTUPLE)
+  find_package(ROOT 6.32 COMPONENTS GenVector EG MathMore ROOTNTuple REQUIRED)
+else ()
+  find_package(ROOT COMPONENTS GenVector EG MathMore REQUIRED)
+endif ()
 include_directories(${ROOT_INCLUDE_DIRS})
 
 ## boost
@@ -63,6 +67,9 @@ include_directories(${HEPMC_INCLUDE_DIR})
 ## HepMC 3
 find_package(HepMC3 REQUIRED)
 include_directories(${HEPMC3_INCLUDE_DIR})
+if (LAGER_HEPMC3_ROOTIO AND NOT HEPMC3_ROOTIO_LIB)
+  message(FATAL_ERROR "LAGER_HEPMC3_ROOTIO is enabled, but HepMC3 has no rootIO")
+endif ()
 
 
 ## PHOTOS
@@ -77,6 +84,18 @@ include_directories(${JPACPHOTO_INCLUDE_DIRS})
 find_package(fmt REQUIRED)
 include_directories(${FMT_INCLUDE_DIRS})
 
+## zlib (and optionally zstd) for the compressed text outputs
+find_package(ZLIB REQUIRED)
+include_directories(${ZLIB_INCLUDE_DIRS})
+if (LAGER_ZSTD)
+  find_path(ZSTD_INCLUDE_DIR zstd.h)
+  find_library(ZSTD_LIBRARY zstd)
+  if (NOT ZSTD_INCLUDE_DIR OR NOT ZSTD_LIBRARY)
+    message(FATAL_ERROR "LAGER_ZSTD is enabled, but zstd was not found")
+  endif ()
+  include_directories(${ZSTD_INCLUDE_DIR})
+endif ()
+
 #if (${CMAKE_SYSTEM_NAME} MATCHES "Darwin")
 #  add_to_rpath_macos("${ROOT_LIBRARY_DIR}")
 #  add_to_rpath_macos("${Boost_LIBRARY_DIRS}")
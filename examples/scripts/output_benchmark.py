@@ -0,0 +1,90 @@
+import argparse
+import copy
+import glob
+import json
+import os
+import re
+import subprocess
+import time
+
+# Benchmark the ROOT output settings: generate the same events for a
+# configuration with different output formats and compression settings, and
+# report the wall time, the time spent filling the output and the file size.
+#
+# Usage: python output_benchmark.py ../solid/solid.ep-phi.json -e 100000
+#
+# With --markdown, the table is printed in markdown, e.g. to add the results for
+# a configuration to the README.
+
+parser = argparse.ArgumentParser('Benchmark the lager output settings')
+
+parser.add_argument('conf', help='path to the lager configuration file.')
+parser.add_argument('-e', dest='events', type=int, default=100000,
+                    help='number of events per setting.')
+parser.add_argument('-o', dest='out', default='output_benchmark',
+                    help='output directory.')
+parser.add_argument('--lager', default='lager', help='path to the lager executable.')
+parser.add_argument('--rntuple', action='store_true',
+                    help='also benchmark the RNTuple format (needs LAGER_RNTUPLE).')
+parser.add_argument('--markdown', action='store_true',
+                    help='print the table in markdown.')
+
+args = parser.parse_args()
+
+# name: output settings
+settings = {
+    'default': {},
+    'zlib-1': {'output_compression': 'zlib', 'output_compression_level': '1'},
+    'lz4-4': {'output_compression': 'lz4', 'output_compression_level': '4'},
+    'zstd-5': {'output_compression': 'zstd', 'output_compression_level': '5'},
+    'columns-zstd-5': {'output_layout': 'columns', 'output_compression': 'zstd',
+                       'output_compression_level': '5'},
+    'columns-zstd-5-imt': {'output_layout': 'columns', 'output_compression': 'zstd',
+                           'output_compression_level': '5', 'output_threads': '4'},
+}
+if args.rntuple:
+    settings['rntuple-zstd-5'] = {'output_format': 'rntuple', 'output_compression': 'zstd',
+                                  'output_compression_level': '5'}
+    settings['rntuple-zstd-5-imt'] = {'output_format': 'rntuple', 'output_compression': 'zstd',
+                                      'output_compression_level': '5', 'output_threads': '4'}
+
+with open(args.conf) as f:
+    conf = json.load(f)
+
+os.makedirs(args.out, exist_ok=True)
+
+# total time spent in the output_tree stage, from the timing table in the log
+timing_re = re.compile(r'output_tree\s+.*?\s+(\d+)\s+([\d.]+)\s+([\d.]+)\s+([\d.]+)\s*$')
+
+header = ('setting', 'wall [s]', 'output [s]', 'output [kHz]', 'size [MB]')
+if args.markdown:
+    print('| ' + ' | '.join(header) + ' |')
+    print('|' + '|'.join(['---'] + ['---:'] * (len(header) - 1)) + '|')
+else:
+    print('{:<22s} {:>10s} {:>12s} {:>12s} {:>12s}'.format(*header))
+for name, extra in settings.items():
+    c = copy.deepcopy(conf)
+    c['mc'].update(extra)
+    # generate a fixed number of events
+    c['mc'].pop('lumi', None)
+    c['mc']['tag'] = 'bench-' + name
+    fconf = os.path.join(args.out, name + '.json')
+    with open(fconf, 'w') as f:
+        json.dump(c, f, indent=2)
+    start = time.time()
+    subprocess.run([args.lager, '-c', fconf, '-r', '1', '-e', str(args.events),
+                    '-o', args.out], check=True, stdout=subprocess.DEVNULL)
+    wall = time.time() - start
+    root = glob.glob(os.path.join(args.out, '*.bench-{}.run*.root'.format(name)))[0]
+    output = 0.
+    with open(root[:-len('.root')] + '.log') as f:
+        for line in f:
+            m = timing_re.search(line)
+            if m:
+                output += float(m.group(2))
+    size = os.path.getsize(root) / 1e6
+    rate = args.events / output / 1e3 if output > 0 else 0.
+    if args.markdown:
+        print('| {} | {:.2f} | {:.2f} | {:.1f} | {:.2f} |'.format(name, wall, output, rate, size))
+    else:
+        print('{:<22s} {:>10.2f} {:>12.2f} {:>12.1f} {:>12.2f}'.format(name, wall, output, rate, size))
@@ -21,12 +21,20 @@ nev = tree.GetEntries()
 kbuf = np.zeros(shape=(nev, len(kcols)))
 pbufs = {ip: np.zeros(shape=(nev, len(pcols))) for ip in list(pars)}
 
+# particles as TParticle objects, or as flat columns (output_layout "columns")
+columns = bool(tree.GetBranch('part_E'))
+
 for iev in np.arange(nev):
     tree.GetEntry(iev)
     kbuf[iev] = (tree.Q2, tree.W, tree.t)
     for ip in list(pars):
-        par = tree.particles[ip]
-        pbufs[ip][iev] = (par.Energy(), par.Ek(), par.Px(), par.Py(), par.Pz())
+        if columns:
+            E, px, py, pz = tree.part_E[ip], tree.part_px[ip], tree.part_py[ip], tree.part_pz[ip]
+            m = np.sqrt(max(E**2 - px**2 - py**2 - pz**2, 0.))
+            pbufs[ip][iev] = (E, E - m, px, py, pz)
+        else:
+            par = tree.particles[ip]
+            pbufs[ip][iev] = (par.Energy(), par.Ek(), par.Px(), par.Py(), par.Pz())
 
 
 res = pd.DataFrame(columns=kcols + [p + '_' + col for _, p in pars.items() for col in pcols ],
@@ -391,8 +391,11 @@ T configuration::get(const string_path& key, const T& default_value) const {
 template <class T>
 T configuration::get(const string_path& key, const T& default_value,
                      const translation_map<T>& tr) const {
-  std::string val{get(key, default_value)};
-  return translate(key, val, tr);
+  auto s = get_optional<T>(key, tr);
+  if (!s) {
+    return default_value;
+  }
+  return *s;
 }
 // and vector versions
 template <class T>
@@ -0,0 +1,204 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_ENVELOPE_LOADED
+#define LAGER_CORE_ENVELOPE_LOADED
+
+#include <algorithm>
+#include <cmath>
+#include <lager/core/assert.hh>
+#include <lager/core/interval.hh>
+#include <lager/core/random.hh>
+#include <vector>
+
+namespace lager {
+
+// =============================================================================
+// Piecewise-constant envelope (majorant) of a cross section over binned
+// (W, Q2, t) cells.
+//
+// The envelope is used to sample t for a given (W, Q2) cell proportional to
+// the cell bounds instead of uniformly over the full t-range. The returned
+// jacobian (relative to uniform sampling) is folded into the cross section, so
+// the cross section times jacobian is bounded by the t-averaged envelope of
+// the (W, Q2) cell, and max() is the corresponding bound for the
+// accept-reject step. As every trial uses the t-distribution it was sampled
+// from, accepted events stay exactly unweighted.
+//
+// The envelope is fixed after the exploration: it is a function of the
+// configuration only, so a run can be reproduced (or resumed) from its work
+// units. The exploration only samples a grid in each cell, so a trial can end
+// up above the bound of its cell (e.g. for a peak inside a bin). The sampling
+// density and the jacobian still cancel for such a trial, the distribution is
+// only wrong once the cross section times jacobian exceeds max() used in the
+// accept-reject step. The event_generator counts and reports these trials as
+// for any other cross section maximum (a larger safety factor or more bins
+// are needed when this happens too often).
+//
+// Usage:
+//    * explore(f, t_limits): fill the envelope with the maximum of the cross
+//      section f(W, Q2, t) on a regular grid in each cell (multiplied with a
+//      safety factor), limited to the kinematically allowed
+//      t_limits(W, Q2). This is done once before generation.
+//    * generate(cell(W, Q2), rng, jacobian): sample t for a trial
+//    * max(cell(W, Q2)): bound on the cross section times jacobian of the
+//      trials in this cell
+//
+// Note: cells without any allowed phase space for all of t are sampled
+//       uniformly. Within a (W, Q2) cell, every t-bin is kept at least at a
+//       fraction floor of the largest bound, so all of the t-range stays
+//       reachable.
+// =============================================================================
+class envelope {
+public:
+  envelope(const interval<double>& W_range, const size_t n_W,
+           const interval<double>& Q2_range, const size_t n_Q2,
+           const interval<double>& t_range, const size_t n_t,
+           const double safety, const double floor)
+      : W_range_{W_range}
+      , Q2_range_{Q2_range}
+      , t_range_{t_range}
+      , n_W_{n_W}
+      , n_Q2_{n_Q2}
+      , n_t_{n_t}
+      , safety_{safety}
+      , floor_{floor}
+      , bound_(n_W * n_Q2 * n_t, 0.)
+      , cumulative_(n_W * n_Q2 * (n_t + 1), 0.) {
+    tassert(n_W > 0 && n_Q2 > 0 && n_t > 0,
+            "envelope needs at least one bin in every dimension");
+    tassert(safety >= 1., "envelope safety factor should be at least 1");
+  }
+
+  // fill the envelope from the function f(W, Q2, t), evaluated on a grid of
+  // n_sub points (including the cell edges) in every dimension of each cell
+  template <class Func, class Limits>
+  void explore(Func&& f, Limits&& t_limits, const size_t n_sub = 3) {
+    tassert(n_sub > 1, "envelope exploration needs at least 2 grid points");
+    for (size_t iW = 0; iW < n_W_; ++iW) {
+      for (size_t iQ2 = 0; iQ2 < n_Q2_; ++iQ2) {
+        const size_t c = iW * n_Q2_ + iQ2;
+        for (size_t jW = 0; jW < n_sub; ++jW) {
+          const double W = edge(W_range_, n_W_, iW + jW / (n_sub - 1.));
+          for (size_t jQ2 = 0; jQ2 < n_sub; ++jQ2) {
+            const double Q2 = edge(Q2_range_, n_Q2_, iQ2 + jQ2 / (n_sub - 1.));
+            const interval<double> tlim = t_limits(W, Q2);
+            for (size_t it = 0; it < n_t_; ++it) {
+              // only consider the allowed part of this t-bin
+              const double tmin = std::max(edge(t_range_, n_t_, it), tlim.min);
+              const double tmax =
+                  std::min(edge(t_range_, n_t_, it + 1.), tlim.max);
+              if (tmin > tmax) {
+                continue;
+              }
+              double& b = bound_[c * n_t_ + it];
+              for (size_t jt = 0; jt < n_sub; ++jt) {
+                const double t = tmin + (tmax - tmin) * jt / (n_sub - 1.);
+                b = std::max(b, f(W, Q2, t));
+              }
+            }
+          }
+        }
+        for (size_t it = 0; it < n_t_; ++it) {
+          bound_[c * n_t_ + it] *= safety_;
+        }
+        update(c);
+      }
+    }
+  }
+
+  // bound on the cross section times jacobian for all cells
+  double max() const {
+    double m = 0;
+    for (size_t c = 0; c < n_W_ * n_Q2_; ++c) {
+      m = std::max(m, max(c));
+    }
+    return m;
+  }
+  // bound on the cross section times jacobian for cell c
+  double max(const size_t c) const {
+    return cumulative_[c * (n_t_ + 1) + n_t_] / n_t_;
+  }
+
+  // (W, Q2) cell index, values outside of the range go to the edge cells
+  size_t cell(const double W, const double Q2) const {
+    return index(W_range_, n_W_, W) * n_Q2_ + index(Q2_range_, n_Q2_, Q2);
+  }
+
+  // sample t for this cell, and update the jacobian for this choice of t
+  // (relative to uniform sampling over the full t-range)
+  double generate(const size_t c, random_engine& rng, double& jacobian) const {
+    const double* cum = &cumulative_[c * (n_t_ + 1)];
+    const double total = cum[n_t_];
+    if (total <= 0) {
+      jacobian = 1.;
+      return rng.Uniform(t_range_.min, t_range_.max);
+    }
+    const double u = rng.Uniform(0, total);
+    const size_t it = std::min<size_t>(
+        std::upper_bound(cum + 1, cum + n_t_ + 1, u) - (cum + 1), n_t_ - 1);
+    const double b = bound_[c * n_t_ + it];
+    jacobian = total / (n_t_ * b);
+    return edge(t_range_, n_t_, it + (u - cum[it]) / b);
+  }
+
+private:
+  // bin edge (for fractional bin numbers, the corresponding point inside the
+  // bin)
+  static double edge(const interval<double>& range, const size_t n,
+                     const double i) {
+    return range.min + range.width() * i / n;
+  }
+  static size_t index(const interval<double>& range, const size_t n,
+                      const double x) {
+    if (range.width() <= 0 || x <= range.min) {
+      return 0;
+    }
+    return std::min<size_t>((x - range.min) / range.width() * n, n - 1);
+  }
+
+  // apply the floor and update the cumulative bounds for cell c
+  void update(const size_t c) {
+    double* b = &bound_[c * n_t_];
+    double* cum = &cumulative_[c * (n_t_ + 1)];
+    const double bmin = *std::max_element(b, b + n_t_) * floor_;
+    cum[0] = 0;
+    for (size_t it = 0; it < n_t_; ++it) {
+      b[it] = std::max(b[it], bmin);
+      cum[it + 1] = cum[it] + b[it];
+    }
+  }
+
+  const interval<double> W_range_;
+  const interval<double> Q2_range_;
+  const interval<double> t_range_;
+  const size_t n_W_;
+  const size_t n_Q2_;
+  const size_t n_t_;
+  const double safety_; // safety factor applied to the explored maxima
+  const double floor_;  // minimum bound, relative to the largest bound in the
+                        // same (W, Q2) cell
+
+  std::vector<double> bound_;      // bound for each (W, Q2, t) cell
+  std::vector<double> cumulative_; // cumulative bounds in t for each (W, Q2)
+};
+
+} // namespace lager
+
+#endif
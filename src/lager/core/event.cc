@@ -21,9 +21,8 @@
 #include <cstring>
 #include <lager/core/logger.hh>
 
-#include <HepMC3/GenEvent.h>
-#include <HepMC3/GenParticle.h>
-#include <HepMC3/GenVertex.h>
+#include <Compression.h>
+#include <TBranch.h>
 
 // =============================================================================
 // IMPLEMENTATION: event_out
@@ -31,35 +30,123 @@
 
 namespace lager {
 event_out::event_out(std::shared_ptr<TFile> f,
-                     std::unique_ptr<HepMC3::WriterAscii> ohepmc,
-                     std::unique_ptr<std::ofstream> ogemc,
-                     std::unique_ptr<std::ofstream> osimc,
-                     const std::string& name)
+                     std::unique_ptr<hepmc_out> ohepmc,
+                     std::unique_ptr<text_writer> ogemc,
+                     std::unique_ptr<text_writer> osimc,
+                     const std::string& name, const position& start,
+                     const particle_layout layout, const output_format format)
     : file_{f}
+    , format_{format}
+#ifdef LAGER_RNTUPLE
+    , ntuple_name_{name}
+#endif
     , ohepmc_{std::move(ohepmc)}
     , ogemc_{std::move(ogemc)}
     , osimc_{std::move(osimc)}
     , parts_{"TParticle", PARTICLE_BUFFER_SIZE}
-    , rc_parts_{"TParticle", PARTICLE_BUFFER_SIZE} {
+    , rc_parts_{"TParticle", PARTICLE_BUFFER_SIZE}
+    , layout_{layout} {
   LOG_INFO("event_out", "Initializing ROOT output stream");
   tassert(file_, "invalid file pointer");
   file_->cd();
-  tree_ = new TTree(name.c_str(), name.c_str());
-  tassert(tree_, "Failed to inialize tree " + name);
+  tree_ = nullptr;
+  if (format_ == output_format::RNTUPLE) {
+#ifdef LAGER_RNTUPLE
+    LOG_INFO("event_out", "Writing the events to RNTuple " + name);
+    tassert(layout_ == particle_layout::COLUMNS,
+            "The RNTuple output requires the columns particle layout");
+    tassert(start.index == 0, "An RNTuple output can not be resumed");
+    model_ = rntuple::RNTupleModel::Create();
+#else
+    tassert(false, "lAger was compiled without RNTuple support (enable the "
+                   "LAGER_RNTUPLE CMake option)");
+#endif
+  } else {
+    file_->GetObject(name.c_str(), tree_);
+    if (tree_) {
+      // continue the tree as it was saved at the last checkpoint
+      LOG_INFO("event_out", "Resuming tree " + name + " at entry " +
+                                std::to_string(start.index));
+      tassert(tree_->GetEntries() == start.index,
+              "Tree " + name + " does not match the checkpoint (" +
+                  std::to_string(tree_->GetEntries()) +
+                  " entries instead of " + std::to_string(start.index) + ")");
+      tassert((tree_->GetBranch("particles") != nullptr) ==
+                  (layout_ == particle_layout::TPARTICLE),
+              "Tree " + name +
+                  " was written with a different particle layout");
+      resumed_ = true;
+      index_ = static_cast<int32_t>(start.index);
+    } else {
+      tree_ = new TTree(name.c_str(), name.c_str());
+    }
+    tassert(tree_, "Failed to inialize tree " + name);
+  }
   create_branches();
+  // the HepMC output already wrote its (fixed) file header, which is dropped
+  // when resuming
+  if (ohepmc_ && resumed_) {
+    ohepmc_->seek(start.hepmc);
+  }
+  if (ogemc_ && resumed_) {
+    ogemc_->seek(start.gemc);
+  }
+  if (osimc_ && resumed_) {
+    osimc_->seek(start.simc);
+  }
+}
+event_out::~event_out() {
+  if (tree_) {
+    tree_->AutoSave();
+  }
+#ifdef LAGER_RNTUPLE
+  // also write an RNTuple without any events, the RNTuple itself is committed
+  // when the writer is destroyed
+  if (format_ == output_format::RNTUPLE && !writer_) {
+    open_ntuple();
+  }
+#endif
+}
+event_out::position event_out::checkpoint() {
+  position pos;
+  pos.index = index_;
+  // write the tree header along with all baskets, so the tree can be read
+  // back at this point even if the file is never closed
+  if (tree_) {
+    tree_->AutoSave("SaveSelf");
+  }
+#ifdef LAGER_RNTUPLE
+  // an RNTuple can only be read back once committed, but we can at least
+  // write out the pending pages
+  if (writer_) {
+    writer_->CommitCluster();
+  }
+#endif
+  if (ohepmc_) {
+    pos.hepmc = ohepmc_->checkpoint();
+  }
+  if (ogemc_) {
+    pos.gemc = ogemc_->checkpoint();
+  }
+  if (osimc_) {
+    pos.simc = osimc_->checkpoint();
+  }
+  return pos;
 }
 void event_out::push(const std::vector<event>& events) {
-  for (const auto e : events) {
+  for (const auto& e : events) {
     push(e);
   }
 }
 void event_out::push(const event& e) {
+  scoped_timer t{timing_, stage_tree_, e.process()};
   evgen_ = e.evgen();
   cross_section_ = static_cast<float>(e.cross_section());
   total_cross_section_ = static_cast<float>(e.total_cross_section());
   process_cross_section_ = static_cast<float>(e.process_cross_section());
   weight_ = static_cast<float>(e.weight());
   process_ = e.process();
+  unit_ = static_cast<int64_t>(e.unit());
   s_ = static_cast<float>(e.s());
   ibeam_index_ = static_cast<int16_t>(e.ibeam_index());
   tbeam_index_ = static_cast<int16_t>(e.tbeam_index());
@@ -73,133 +160,56 @@ void event_out::push(const event& e) {
   }
 
   // fill the tree
-  tree_->Fill();
+  fill();
 
   // increment the index for the next event, and clear the particle buffer
   index_ += 1;
   clear();
+  t.stop();
 
   // write HEPMC record if wanted
   if (ohepmc_) {
-    write_hepmc(e);
+    scoped_timer th{timing_, stage_hepmc_, e.process()};
+    // event number: index of the event in the tree
+    ohepmc_->write(e, index_ - 1);
   }
 
   // write GEMC record if wanted
   if (ogemc_) {
+    scoped_timer tg{timing_, stage_gemc_, e.process()};
     write_gemc(e);
   }
   // write SIMC record if wanted
   if (osimc_) {
+    scoped_timer ts{timing_, stage_simc_, e.process()};
     write_simc(e);
   }
 
   // that's all
 }
 
-void event_out::write_hepmc(const event& e) {
-  // event index
-  static size_t index = 0;
-  // create event
-  HepMC3::GenEvent hevt(HepMC3::Units::GEV, HepMC3::Units::CM);
-  // get vector of HepMC particles corresponding to our particles
-  std::vector<HepMC3::GenParticlePtr> hepmc_part;
-  std::transform(e.part().begin(), e.part().end(),
-                 std::back_inserter(hepmc_part), [](const particle& part) {
-                   // undefined: 0
-                   // final state: 1
-                   // decayed: 2
-                   // documentation: 3
-                   // incoming: 4
-                   int status = 0;
-                   if (part.final_state()) {
-                     status = 1;
-                   } else if (part.decayed()) {
-                     status = 2;
-                   } else if (part.documentation()) {
-                     status = 3;
-                   } else if (part.status() ==
-                              particle::status_code::SECONDARY_BEAM) {
-                     // virtual photon
-                     if (part.type() == pdg_id::gamma) {
-                       status = 13;
-                       // nucleon in nucleus
-                     } else {
-                       status = 2;
-                     }
-                   } else if (part.status() == particle::status_code::BEAM) {
-                     status = 4;
-                   }
-                   return HepMC3::GenParticlePtr(new HepMC3::GenParticle(
-                       HepMC3::FourVector(part.p().X(), part.p().Y(),
-                                          part.p().Z(), part.p().E()),
-                       part.type<int>(), status));
-                 });
-  // record of "processed" particles. A particle is processed once it is added
-  // as incoming leg of a vertex
-  std::vector<size_t> finished;
-  // loop over all particles, find and create vertices and build the HepMC event
-  for (size_t i = 0; i < e.part().size(); ++i) {
-    const auto& part = e.part(i);
-    // 0. Only create vertices from "incoming" lines
-    if (e.part(i).n_daughters() == 0) {
-      continue;
-    }
-    const auto& first_daughter = e.part(part.daughter_begin());
-    // 1. Check if track is already "processed"
-    if (std::any_of(finished.begin(), finished.end(),
-                    [i](int j) { return (j == i); })) {
-      continue;
-    }
-    // 2. OK, let's create a new vertex for this particle
-    //    In principle the vertex member of a particle is the start vertex,
-    //    so we get the relevant vertex from the first daughter particle instead
-    auto raw_vertex = first_daughter.vertex();
-    auto vx = HepMC3::GenVertexPtr(new HepMC3::GenVertex(HepMC3::FourVector(
-        raw_vertex.X(), raw_vertex.Y(), raw_vertex.Z(), raw_vertex.T())));
-    // 3. Attach incoming lines to this vertex and mark them as "finished"
-    //    Use the first daughter to get the full list of incoming lines
-    for (int iin :
-         {first_daughter.parent_first(), first_daughter.parent_second()}) {
-      if (iin < 0) {
-        continue;
-      }
-      vx->add_particle_in(hepmc_part[iin]);
-      finished.push_back(iin);
-    }
-    // 4. attach outgoing line to this vertex
-    for (int iout = part.daughter_begin(); iout < part.daughter_end(); ++iout) {
-      vx->add_particle_out(hepmc_part[iout]);
-    }
-    // 5. Add vertex to event
-    hevt.add_vertex(vx);
-  }
-  // Now we are ready to write out the event
-  ohepmc_->write_event(hevt);
-}
-
+// the formats match the original printf formats (with explicit right alignment
+// for inf and nan), so the output is unchanged
 void event_out::write_gemc(const event& e) {
-  char buf[2048];
   // write the first line of the event record
-  snprintf(buf, 2048, "%5zu %5i %5i %5f %5f %5i %5f %5i %5i %8.6e\n",
-           e.count_final_state(), 1, 1, 0., 0., 11, e.ibeam().energy(), 0,
-           e.process(), e.total_cross_section());
-  *ogemc_ << buf;
+  ogemc_->print(FMT_STRING("{:5} {:5} {:5} {:>5f} {:>5f} {:5} {:>5f} {:5} {:5} "
+                           "{:>8.6e}\n"),
+                e.count_final_state(), 1, 1, 0., 0., 11, e.ibeam().energy(), 0,
+                e.process(), e.total_cross_section());
   for (const auto& part : e) {
     if (!part.final_state()) {
       continue;
     }
-    snprintf(buf, 2048,
-             "%5i %5f  %5i %5i %5i %5i %8.6e %8.6e %8.6e %8.6e %8.6e %8.6e "
-             "%8.6e %8.6e\n",
-             part.index(), part.lifetime(), 1, part.type<int>(),
-             part.parent_first(), part.daughter_begin(), part.p().x(),
-             part.p().y(), part.p().z(), part.energy(), part.mass(),
-             part.vertex().x(), part.vertex().y(), part.vertex().z());
-    *ogemc_ << buf;
+    ogemc_->print(FMT_STRING("{:5} {:>5f}  {:5} {:5} {:5} {:5} {:>8.6e} "
+                             "{:>8.6e} {:>8.6e} {:>8.6e} {:>8.6e} {:>8.6e} "
+                             "{:>8.6e} {:>8.6e}\n"),
+                  part.index(), part.lifetime(), 1, part.type<int>(),
+                  part.parent_first(), part.daughter_begin(), part.p().x(),
+                  part.p().y(), part.p().z(), part.energy(), part.mass(),
+                  part.vertex().x(), part.vertex().y(), part.vertex().z());
   }
 }
 void event_out::write_simc(const event& e) {
-  char buf[1024];
   // assume HMS is detector ID 1 and SHMS is detector ID 2
   auto hms_track =
       std::find_if(e.detected().begin(), e.detected().end(),
@@ -209,24 +219,139 @@ void event_out::write_simc(const event& e) {
                    [](const auto& part) { return part.status() == 2; });
   auto end = e.detected().end();
   if (hms_track != end && shms_track != end) {
-    snprintf(buf, 1024,
-             "%16.10e %16.10e %16.10e %16.10e %16.10e %16.10e %16.10e %16.10e "
-             "%16.10e %16.10e %16.10e\n",
-             hms_track->p().X(), hms_track->p().Y(), hms_track->p().Z(),
-             hms_track->energy(), hms_track->vertex().Z(), shms_track->p().X(),
-             shms_track->p().Y(), shms_track->p().Z(), shms_track->energy(),
-             shms_track->vertex().Z(), 1.);
-    *osimc_ << buf;
+    osimc_->print(FMT_STRING("{:>16.10e} {:>16.10e} {:>16.10e} {:>16.10e} "
+                             "{:>16.10e} {:>16.10e} {:>16.10e} {:>16.10e} "
+                             "{:>16.10e} {:>16.10e} {:>16.10e}\n"),
+                  hms_track->p().X(), hms_track->p().Y(), hms_track->p().Z(),
+                  hms_track->energy(), hms_track->vertex().Z(),
+                  shms_track->p().X(), shms_track->p().Y(),
+                  shms_track->p().Z(), shms_track->energy(),
+                  shms_track->vertex().Z(), 1.);
+  }
+}
+
+const translation_map<event_out::particle_layout>&
+event_out::layout_translator() {
+  static const translation_map<particle_layout> tr{
+      {"tparticle", particle_layout::TPARTICLE},
+      {"columns", particle_layout::COLUMNS}};
+  return tr;
+}
+
+const translation_map<event_out::output_format>&
+event_out::format_translator() {
+  static const translation_map<output_format> tr{
+      {"ttree", output_format::TTREE}, {"rntuple", output_format::RNTUPLE}};
+  return tr;
+}
+
+const translation_map<int>& event_out::compression_translator() {
+  using algorithm = ROOT::RCompressionSetting::EAlgorithm;
+  static const translation_map<int> tr{{"zlib", algorithm::kZLIB},
+                                       {"lzma", algorithm::kLZMA},
+                                       {"lz4", algorithm::kLZ4},
+                                       {"zstd", algorithm::kZSTD}};
+  return tr;
+}
+
+int event_out::default_compression_level(const int algorithm) {
+  using algo = ROOT::RCompressionSetting::EAlgorithm;
+  using level = ROOT::RCompressionSetting::ELevel;
+  switch (algorithm) {
+  case algo::kZLIB:
+    return level::kDefaultZLIB;
+  case algo::kLZMA:
+    return level::kDefaultLZMA;
+  case algo::kLZ4:
+    return level::kDefaultLZ4;
+  case algo::kZSTD:
+    return level::kDefaultZSTD;
   }
+  tassert(false, "Unknown ROOT compression algorithm");
+  return 0;
+}
+
+void event_out::configure(const write_settings& ws) {
+  if (resumed_) {
+    LOG_WARNING("event_out", "Keeping the write settings of the resumed tree");
+    return;
+  }
+  if (tree_) {
+    if (ws.compression >= 0) {
+      // also sets the compression of the sub-branches
+      for (auto* obj : *tree_->GetListOfBranches()) {
+        static_cast<TBranch*>(obj)->SetCompressionSettings(ws.compression);
+      }
+    }
+    if (ws.basket_size > 0) {
+      tree_->SetBasketSize("*", ws.basket_size);
+    }
+    if (ws.cluster_size != 0) {
+      tree_->SetAutoFlush(ws.cluster_size);
+    }
+    return;
+  }
+#ifdef LAGER_RNTUPLE
+  tassert(!writer_, "RNTuple write settings changed after the first event");
+  if (ws.compression >= 0) {
+    ntuple_options_.SetCompression(ws.compression);
+  }
+  if (ws.basket_size > 0) {
+    LOG_WARNING("event_out", "The basket size is ignored for an RNTuple");
+  }
+  if (ws.cluster_size > 0) {
+    LOG_WARNING("event_out", "The RNTuple cluster size can only be set in "
+                             "bytes (negative value)");
+  } else if (ws.cluster_size < 0) {
+    ntuple_options_.SetApproxZippedClusterSize(-ws.cluster_size);
+  }
+#endif
+}
+
+void event_out::open_ntuple() {
+#ifdef LAGER_RNTUPLE
+  writer_ = rntuple::RNTupleWriter::Append(std::move(model_), ntuple_name_,
+                                           *file_, ntuple_options_);
+  entry_ = writer_->CreateEntry();
+  for (const auto& bind : bindings_) {
+    bind(*entry_);
+  }
+#endif
+}
+void event_out::fill() {
+  if (tree_) {
+    tree_->Fill();
+    return;
+  }
+#ifdef LAGER_RNTUPLE
+  if (!writer_) {
+    open_ntuple();
+  }
+  writer_->Fill(*entry_);
+#endif
 }
 
 void event_out::clear() {
   n_part_ = 0;
   rc_n_part_ = 0;
+  if (layout_ == particle_layout::COLUMNS) {
+    part_cols_.clear();
+    rc_part_cols_.clear();
+    return;
+  }
   parts_.Clear();
   rc_parts_.Clear();
 }
 void event_out::add(const particle& part) {
+  if (layout_ == particle_layout::COLUMNS) {
+    part_cols_.add(static_cast<int32_t>(part.type()),
+                   static_cast<int32_t>(part.status()), part.parent_first(),
+                   part.parent_second(), part.daughter_begin(),
+                   part.daughter_end(), part.p(), part.vertex(),
+                   part.final_state() ? 1. : 0.);
+    n_part_ += 1;
+    return;
+  }
   auto pbuf = new (parts_[n_part_]) TParticle(
       static_cast<int32_t>(part.type()), static_cast<int32_t>(part.status()),
       part.parent_first(), part.parent_second(), part.daughter_begin(),
@@ -240,6 +365,13 @@ void event_out::add(const particle& part) {
 }
 // add a detected particle to the buffer
 void event_out::add_detected(const detected_particle& dp) {
+  if (layout_ == particle_layout::COLUMNS) {
+    rc_part_cols_.add(dp.generated().type<int32_t>(), dp.status(),
+                      dp.generated().index(), 0, 0, 0, dp.p(), dp.vertex(),
+                      1.);
+    rc_n_part_ += 1;
+    return;
+  }
   auto pbuf = new (rc_parts_[rc_n_part_])
       TParticle(static_cast<int32_t>(dp.generated().type<int32_t>()),
                 dp.status(), dp.generated().index(), 0, 0, 0, dp.p().X(),
@@ -250,20 +382,89 @@ void event_out::add_detected(const detected_particle& dp) {
 }
 
 void event_out::create_branches() {
-  tree_->Branch("index", &index_);
-  tree_->Branch("evgen", &evgen_);
-  tree_->Branch("cross_section", &cross_section_);
-  tree_->Branch("total_cross_section", &total_cross_section_);
-  tree_->Branch("process_cross_section", &process_cross_section_);
-  tree_->Branch("weight", &weight_);
-  tree_->Branch("process", &process_);
-  tree_->Branch("s", &s_);
-  tree_->Branch("ibeam_index", &ibeam_index_);
-  tree_->Branch("tbeam_index", &tbeam_index_);
-  tree_->Branch("n_part", &n_part_);
-  tree_->Branch("particles", &parts_);
-  tree_->Branch("rc_n_part", &rc_n_part_);
-  tree_->Branch("rc_particles", &rc_parts_);
+  branch("index", &index_);
+  branch("evgen", &evgen_);
+  branch("cross_section", &cross_section_);
+  branch("total_cross_section", &total_cross_section_);
+  branch("process_cross_section", &process_cross_section_);
+  branch("weight", &weight_);
+  branch("process", &process_);
+  branch("unit", &unit_);
+  branch("s", &s_);
+  branch("ibeam_index", &ibeam_index_);
+  branch("tbeam_index", &tbeam_index_);
+  branch("n_part", &n_part_);
+  branch("rc_n_part", &rc_n_part_);
+  if (layout_ == particle_layout::COLUMNS) {
+    create_column_branches("part_", part_cols_, false);
+    create_column_branches("rc_part_", rc_part_cols_, true);
+    return;
+  }
+  if (resumed_) {
+    tree_->SetBranchAddress("particles", &parts_ptr_);
+    tree_->SetBranchAddress("rc_particles", &rc_parts_ptr_);
+  } else {
+    tree_->Branch("particles", &parts_);
+    tree_->Branch("rc_particles", &rc_parts_);
+  }
+}
+void event_out::create_column_branches(const std::string& prefix,
+                                       particle_columns& cols,
+                                       const bool detected) {
+  auto name = [&](const char* col) { return prefix + col; };
+  branch(name("pid").c_str(), &cols.pid);
+  branch(name("status").c_str(), &cols.status);
+  if (detected) {
+    // index of the corresponding generated particle
+    branch(name("index").c_str(), &cols.parent1);
+  } else {
+    branch(name("parent1").c_str(), &cols.parent1);
+    branch(name("parent2").c_str(), &cols.parent2);
+    branch(name("daughter1").c_str(), &cols.daughter1);
+    branch(name("daughter2").c_str(), &cols.daughter2);
+  }
+  branch(name("px").c_str(), &cols.px);
+  branch(name("py").c_str(), &cols.py);
+  branch(name("pz").c_str(), &cols.pz);
+  branch(name("E").c_str(), &cols.E);
+  branch(name("vx").c_str(), &cols.vx);
+  branch(name("vy").c_str(), &cols.vy);
+  branch(name("vz").c_str(), &cols.vz);
+  branch(name("vt").c_str(), &cols.vt);
+  if (!detected) {
+    // 1 for final state particles, 0 otherwise
+    branch(name("weight").c_str(), &cols.weight);
+  }
+}
+
+void event_out::particle_columns::clear() {
+  for (auto* c : {&pid, &status, &parent1, &parent2, &daughter1, &daughter2}) {
+    c->data.clear();
+  }
+  for (auto* c : {&px, &py, &pz, &E, &vx, &vy, &vz, &vt, &weight}) {
+    c->data.clear();
+  }
+}
+void event_out::particle_columns::add(
+    const int32_t pid, const int32_t status, const int32_t parent1,
+    const int32_t parent2, const int32_t daughter1, const int32_t daughter2,
+    const particle::XYZTVector& p, const particle::XYZTVector& v,
+    const double weight) {
+  this->pid.data.push_back(pid);
+  this->status.data.push_back(status);
+  this->parent1.data.push_back(parent1);
+  this->parent2.data.push_back(parent2);
+  this->daughter1.data.push_back(daughter1);
+  this->daughter2.data.push_back(daughter2);
+  px.data.push_back(p.X());
+  py.data.push_back(p.Y());
+  pz.data.push_back(p.Z());
+  E.data.push_back(p.E());
+  vx.data.push_back(v.X());
+  vy.data.push_back(v.Y());
+  vz.data.push_back(v.Z());
+  vt.data.push_back(v.T());
+  this->weight.data.push_back(weight);
 }
 
 } // namespace lager
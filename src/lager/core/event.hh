@@ -23,34 +23,226 @@
 #include <lager/core/assert.hh>
 #include <lager/core/event.hh>
 #include <lager/core/generator.hh>
+#include <lager/core/hepmc_out.hh>
 #include <lager/core/particle.hh>
+#include <lager/core/small_vector.hh>
+#include <lager/core/text_writer.hh>
+#include <lager/core/timer.hh>
 
 #include <TClonesArray.h>
 #include <TFile.h>
 #include <TParticle.h>
 #include <TTree.h>
 
-#include <HepMC3/WriterAscii.h>
+#ifdef LAGER_RNTUPLE
+#include <ROOT/REntry.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+#include <RVersion.h>
+#endif
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace lager {
 
+// =============================================================================
+// buffer_pool
+//
+// Pool of empty buffers that keep their capacity. Events take their particle
+// buffers from the pool on construction, and return them on destruction, so
+// in steady state filling an event does not need any heap allocations.
+//
+// Note: events are typically generated in a worker thread and destroyed after
+//       the output step in the main thread. Every thread therefore keeps its
+//       own cache of free buffers, and only exchanges batches of BATCH_SIZE
+//       buffers with the shared pool, so the shared lock is taken once per
+//       batch instead of for every event.
+// =============================================================================
+template <class T> class buffer_pool {
+public:
+  constexpr static const size_t MAX_BUFFERS{4096}; // max number of buffers
+  constexpr static const size_t BATCH_SIZE{64};    // buffers per exchange
+
+  static std::vector<T> get() {
+    auto& free = cache().buffers;
+    if (free.empty()) {
+      shared().take(free);
+      if (free.empty()) {
+        return {};
+      }
+    }
+    std::vector<T> buf{std::move(free.back())};
+    free.pop_back();
+    return buf;
+  }
+  static void put(std::vector<T>& buf) {
+    // nothing to recycle for moved-from or never used buffers
+    if (buf.capacity() == 0) {
+      return;
+    }
+    buf.clear();
+    auto& free = cache().buffers;
+    free.push_back(std::move(buf));
+    if (free.size() >= 2 * BATCH_SIZE) {
+      shared().give(free, BATCH_SIZE);
+    }
+  }
+
+private:
+  using buffer_list = std::vector<std::vector<T>>;
+
+  // shared pool, only accessed in batches
+  struct shared_pool {
+    std::mutex mutex;
+    buffer_list buffers;
+
+    // move up to BATCH_SIZE buffers to free
+    void take(buffer_list& free) {
+      std::lock_guard<std::mutex> lock{mutex};
+      const size_t n = std::min(buffers.size(), BATCH_SIZE);
+      std::move(buffers.end() - n, buffers.end(), std::back_inserter(free));
+      buffers.resize(buffers.size() - n);
+    }
+    // move the last n buffers from free to the pool (buffers beyond
+    // MAX_BUFFERS are released)
+    void give(buffer_list& free, const size_t n) {
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        const size_t keep = std::min(n, MAX_BUFFERS - std::min(MAX_BUFFERS,
+                                                               buffers.size()));
+        std::move(free.end() - keep, free.end(), std::back_inserter(buffers));
+      }
+      free.resize(free.size() - n);
+    }
+  };
+  // per-thread cache, handed back to the shared pool when the thread exits
+  struct thread_cache {
+    buffer_list buffers;
+    ~thread_cache() { shared().give(buffers, buffers.size()); }
+  };
+
+  static shared_pool& shared() {
+    static shared_pool pool;
+    return pool;
+  }
+  static thread_cache& cache() {
+    thread_local thread_cache c;
+    return c;
+  }
+};
+
+// =============================================================================
+// particle_storage
+//
+// Generated and detected particle lists of the event record.
+//
+// By default, the lists are std::vectors that take their buffers from (and
+// return them to) the buffer_pool. When compiled with LAGER_INLINE_PARTICLES,
+// the lists are small_vectors that keep up to INLINE_PARTICLES particles
+// inside the event record itself. Typical events then need no heap memory at
+// all, and the particles are next to the event info in memory, at the cost of
+// a larger event record.
+//
+// Copying (or moving) the lists re-points the detected particles to the
+// generated particles of the new event record.
+// =============================================================================
+#ifdef LAGER_INLINE_PARTICLES
+constexpr static const size_t INLINE_PARTICLES{16};
+using particle_list = small_vector<particle, INLINE_PARTICLES>;
+using detected_list = small_vector<detected_particle, INLINE_PARTICLES>;
+#else
+using particle_list = std::vector<particle>;
+using detected_list = std::vector<detected_particle>;
+#endif
+
+class particle_storage {
+protected:
+  // only take buffers from the pool for pooled storage, so that empty records
+  // (e.g. rejected events) never touch the pool
+  explicit particle_storage(const bool pooled) {
+#ifndef LAGER_INLINE_PARTICLES
+    if (pooled) {
+      part_ = buffer_pool<particle>::get();
+      detected_ = buffer_pool<detected_particle>::get();
+    }
+#endif
+  }
+  particle_storage(const particle_storage& rhs)
+      : part_{rhs.part_}, detected_{rhs.detected_} {
+    relink(rhs.part_.data());
+  }
+  particle_storage(particle_storage&& rhs) noexcept
+      : particle_storage{std::move(rhs), rhs.part_.data()} {}
+  particle_storage& operator=(const particle_storage& rhs) {
+    const particle* old = rhs.part_.data();
+    part_ = rhs.part_;
+    detected_ = rhs.detected_;
+    relink(old);
+    return *this;
+  }
+  particle_storage& operator=(particle_storage&& rhs) noexcept {
+    if (this != &rhs) {
+      const particle* old = rhs.part_.data();
+      release();
+      part_ = std::move(rhs.part_);
+      detected_ = std::move(rhs.detected_);
+      relink(old);
+    }
+    return *this;
+  }
+  ~particle_storage() { release(); }
+
+  particle_list part_;
+  detected_list detected_;
+
+private:
+  // move constructor, old is the location of the particles in rhs
+  particle_storage(particle_storage&& rhs, const particle* old) noexcept
+      : part_{std::move(rhs.part_)}, detected_{std::move(rhs.detected_)} {
+    relink(old);
+  }
+  // point the detected particles to our own generated particles, for
+  // generated particles that used to be stored at old
+  void relink(const particle* old) {
+    if (old == part_.data()) {
+      return;
+    }
+    for (auto& dp : detected_) {
+      dp.relink(old, part_.data(), part_.size());
+    }
+  }
+  // return the buffers to the pool
+  void release() {
+#ifndef LAGER_INLINE_PARTICLES
+    buffer_pool<particle>::put(part_);
+    buffer_pool<detected_particle>::put(detected_);
+#endif
+  }
+};
+
 // =============================================================================
 // event
 //
 // base event record that carries a list of all particles
 // derive form this class for more specialized event records
 // =============================================================================
-class event : public generator_data {
+class event : public generator_data, private particle_storage {
 public:
   event(const event&) = default;
+  event(event&&) = default;
   event& operator=(const event&) = default;
+  event& operator=(event&&) = default;
+  // rejected events (zero cross section) are never filled, and do not take
+  // particle buffers from the pool
   explicit event(const double xs = 1., const double w = 1.)
-      : generator_data{xs}, weight_{w} {}
+      : generator_data{xs}, particle_storage{xs > 0}, weight_{w} {}
 
   // ===========================================================================
   // EVENT INFO
@@ -62,6 +254,8 @@ public:
   double process_cross_section() const { return process_cross_section_; }
   double weight() const { return weight_; }
   int process() const { return process_; }
+  // work unit (RNG stream position) this event was generated in
+  uint64_t unit() const { return unit_; }
 
   // event CM energy (from beam/target)
   double s() const;
@@ -72,6 +266,7 @@ public:
   // space)
   void update_stat(const size_t evgen, const double txs);
   void update_process(const int proc);
+  void update_unit(const uint64_t unit) { unit_ = unit; }
   // update weight and process number
   void update_weight(const double w) { weight_ *= w; }
   void reset_weight(const double w = 1.) { weight_ = w; }
@@ -96,8 +291,8 @@ public:
   // access particle info
   particle& operator[](const int index) { return part_[index]; }
   const particle& operator[](const int index) const { return part_[index]; }
-  std::vector<particle>& part() { return part_; }
-  const std::vector<particle>& part() const { return part_; }
+  particle_list& part() { return part_; }
+  const particle_list& part() const { return part_; }
   particle& part(const int index) { return part_[index]; }
   const particle& part(const int index) const { return part_[index]; }
 
@@ -105,10 +300,10 @@ public:
   size_t size() const { return part_.size(); }
 
   // particle iterators
-  std::vector<particle>::iterator begin() { return part_.begin(); }
-  std::vector<particle>::const_iterator begin() const { return part_.begin(); }
-  std::vector<particle>::iterator end() { return part_.end(); }
-  std::vector<particle>::const_iterator end() const { return part_.end(); }
+  particle_list::iterator begin() { return part_.begin(); }
+  particle_list::const_iterator begin() const { return part_.begin(); }
+  particle_list::iterator end() { return part_.end(); }
+  particle_list::const_iterator end() const { return part_.end(); }
 
   // add a misc particle. returns the index of the particle
   int add_particle(const particle& p);
@@ -138,8 +333,8 @@ public:
   // DETECTOR INFO
   //
   // access detector info
-  std::vector<detected_particle>& detected() { return detected_; }
-  const std::vector<detected_particle>& detected() const { return detected_; }
+  detected_list& detected() { return detected_; }
+  const detected_list& detected() const { return detected_; }
   detected_particle& detected(const int index) { return detected_[index]; }
   const detected_particle& detected(const int index) const;
 
@@ -151,15 +346,30 @@ private:
   double process_cross_section_{0.}; // differential process cross section
   double weight_{1.};
   int process_{0}; // optional process identifier
+  uint64_t unit_{0}; // work unit index
 
   double s_; // mandelstam s, automatically calculated from beam and target
 
   int ibeam_index_{-1};
   int tbeam_index_{-1};
+};
+} // namespace lager
 
-  //
-  std::vector<particle> part_;
-  std::vector<detected_particle> detected_;
+// =============================================================================
+// output_position
+//
+// Output position: number of events in the tree and the byte offsets in the
+// text outputs.
+//
+// Note: defined outside of event_out, so it can be used as a default argument
+//       of the event_out constructor.
+// =============================================================================
+namespace lager {
+struct output_position {
+  int64_t index{0};
+  int64_t hepmc{0};
+  int64_t gemc{0};
+  int64_t simc{0};
 };
 } // namespace lager
 
@@ -173,22 +383,84 @@ private:
 //    * Make sure to define your own push(your_event_type) method, and call the
 //      parent push(parent_event_type) from within the method.
 //    * you are responsible to create the necessary branches for your custom
-//      event type, the main event branches are added by this base class
+//      event type (through branch()), the main event branches are added by
+//      this base class
+//
+// Particle layout:
+//    * TPARTICLE (default): the generated and detected particles are stored
+//      as TClonesArrays of TParticle ("particles" and "rc_particles")
+//    * COLUMNS: the same content is stored as flat vector branches, one per
+//      particle property ("part_pid", "part_px", ..., and "rc_part_pid",
+//      ...). Faster to fill, compresses better, and the columns can be read
+//      separately (e.g. with RDataFrame or uproot).
+//
+// Output format:
+//    * TTREE (default): the events are stored in a TTree
+//    * RNTUPLE: the events are stored in an RNTuple with the same fields as
+//      the tree branches (only with the COLUMNS particle layout, and only
+//      when compiled with LAGER_RNTUPLE). The RNTuple is written when the
+//      first event is pushed (so derived classes can add their fields first),
+//      and is committed to the file on destruction. The pages are compressed
+//      in parallel when ROOT's implicit multi-threading is enabled.
+//
+// Write settings:
+//    * configure() sets the compression, basket size and cluster size (auto
+//      flush) of a new output, and should be called before the first event
+//      is pushed. A resumed tree keeps its original settings.
+//
+// Checkpoints:
+//    * checkpoint() flushes all outputs and returns the output position
+//    * an RNTuple can not be resumed, as it is only complete once committed
+//    * if the file already contains the tree, the output is resumed from the
+//      last checkpoint: the tree is reused, and the text outputs (which should
+//      be opened without truncation) continue from the positions in
+//      "start". Outputs written after the last checkpoint are overwritten.
 // =============================================================================
 
 // TODO needs refactoring of the output plugins
 //      --> migrate to config-based approach rather
 //          than hardcoded compontents
 namespace lager {
+#ifdef LAGER_RNTUPLE
+// RNTuple moved out of ROOT::Experimental in ROOT 6.36
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 36, 0)
+namespace rntuple = ::ROOT;
+#else
+namespace rntuple = ::ROOT::Experimental;
+#endif
+#endif
+
 class event_out {
 public:
   constexpr static const int32_t PARTICLE_BUFFER_SIZE{1000};
 
-  event_out(std::shared_ptr<TFile> f,
-            std::unique_ptr<HepMC3::WriterAscii> ohepmc,
-            std::unique_ptr<std::ofstream> ogemc,
-            std::unique_ptr<std::ofstream> osimc, const std::string& name);
-  ~event_out() { tree_->AutoSave(); }
+  enum class particle_layout { TPARTICLE, COLUMNS };
+  static const translation_map<particle_layout>& layout_translator();
+  enum class output_format { TTREE, RNTUPLE };
+  static const translation_map<output_format>& format_translator();
+  // ROOT compression algorithms
+  static const translation_map<int>& compression_translator();
+  // ROOT's recommended compression level for an algorithm
+  static int default_compression_level(const int algorithm);
+
+  // ROOT write settings, 0 (or -1 for the compression) to keep the default
+  struct write_settings {
+    int compression{-1};     // ROOT compression settings (algorithm * 100 +
+                             // level)
+    int32_t basket_size{0};  // TTree basket size [bytes]
+    int64_t cluster_size{0}; // TTree auto flush (> 0: events, < 0: bytes),
+                             // or RNTuple zipped cluster size (< 0 only)
+  };
+
+  using position = output_position;
+
+  event_out(std::shared_ptr<TFile> f, std::unique_ptr<hepmc_out> ohepmc,
+            std::unique_ptr<text_writer> ogemc,
+            std::unique_ptr<text_writer> osimc, const std::string& name,
+            const position& start = {},
+            const particle_layout layout = particle_layout::TPARTICLE,
+            const output_format format = output_format::TTREE);
+  ~event_out();
 
   // no implicit default constructors
   event_out() = delete;
@@ -199,10 +471,89 @@ public:
   void push(const event& e);
   void push(const std::vector<event>& e);
 
+  // the output tree (nullptr for the RNTuple output)
   TTree* tree() { return tree_; }
 
+  // time spent writing the different outputs
+  stage_timing& timing() { return timing_; }
+
+  // apply the write settings (before the first event is pushed)
+  void configure(const write_settings& ws);
+
+  // flush all outputs to disk, and return the current output position
+  position checkpoint();
+
+protected:
+  // create a new branch (or RNTuple field), or attach to the existing branch
+  // when resuming
+  template <class T> void branch(const char* name, T* address) {
+    if (format_ == output_format::RNTUPLE) {
+      field(name, address);
+    } else if (resumed_) {
+      tree_->SetBranchAddress(name, address);
+    } else {
+      tree_->Branch(name, address);
+    }
+  }
+
 private:
-  void write_hepmc(const event& e);
+  // a flat column for the columnar particle layout, with the pointer ROOT
+  // needs to attach to an existing branch
+  template <class T> struct column {
+    std::vector<T> data;
+    std::vector<T>* ptr{&data};
+  };
+  // particle columns, the detected particles only use the columns that are
+  // also filled in the TParticle layout
+  struct particle_columns {
+    column<int32_t> pid;
+    column<int32_t> status;
+    column<int32_t> parent1;
+    column<int32_t> parent2;
+    column<int32_t> daughter1;
+    column<int32_t> daughter2;
+    column<double> px;
+    column<double> py;
+    column<double> pz;
+    column<double> E;
+    column<double> vx;
+    column<double> vy;
+    column<double> vz;
+    column<double> vt;
+    column<double> weight;
+    void clear();
+    void add(const int32_t pid, const int32_t status, const int32_t parent1,
+             const int32_t parent2, const int32_t daughter1,
+             const int32_t daughter2, const particle::XYZTVector& p,
+             const particle::XYZTVector& v, const double weight);
+  };
+  template <class T> void branch(const char* name, column<T>* c) {
+    if (format_ == output_format::RNTUPLE) {
+      field(name, &c->data);
+    } else if (resumed_) {
+      tree_->SetBranchAddress(name, &c->ptr);
+    } else {
+      tree_->Branch(name, &c->data);
+    }
+  }
+  void create_column_branches(const std::string& prefix,
+                              particle_columns& cols, const bool detected);
+
+  // add an RNTuple field, the address is bound to the entry once the
+  // RNTuple is written
+  template <class T> void field(const std::string& name, T* address) {
+#ifdef LAGER_RNTUPLE
+    model_->MakeField<T>(name);
+    bindings_.push_back([name, address](rntuple::REntry& entry) {
+      entry.BindRawPtr(name, address);
+    });
+#endif
+  }
+  // create the RNTuple writer and its entry (freezes the model)
+  void open_ntuple();
+  // write the event buffer to the tree or RNTuple
+  void fill();
+
   void write_gemc(const event& e);
   void write_simc(const event& e);
 
@@ -219,9 +570,21 @@ private:
   // file and tree
   std::shared_ptr<TFile> file_;
   TTree* tree_; // raw pointer because the TFile will have ownership of the tree
-  std::unique_ptr<HepMC3::WriterAscii> ohepmc_; // HEPMC output stream
-  std::unique_ptr<std::ofstream> ogemc_;       // GEMC output stream
-  std::unique_ptr<std::ofstream> osimc_;       // SIMC output stream
+  bool resumed_{false}; // true if we continue an existing tree
+  const output_format format_;
+#ifdef LAGER_RNTUPLE
+  // or RNTuple (the writer is destroyed before the file, which commits the
+  // RNTuple)
+  const std::string ntuple_name_;
+  std::unique_ptr<rntuple::RNTupleModel> model_;
+  std::vector<std::function<void(rntuple::REntry&)>> bindings_;
+  std::unique_ptr<rntuple::RNTupleWriter> writer_;
+  std::unique_ptr<rntuple::REntry> entry_;
+  rntuple::RNTupleWriteOptions ntuple_options_;
+#endif
+  std::unique_ptr<hepmc_out> ohepmc_;   // HEPMC output
+  std::unique_ptr<text_writer> ogemc_; // GEMC output stream
+  std::unique_ptr<text_writer> osimc_; // SIMC output stream
 
   // event data
   int32_t index_{0};
@@ -231,6 +594,7 @@ private:
   float process_cross_section_;
   float weight_;
   int32_t process_;
+  int64_t unit_;
   float s_;
   int16_t ibeam_index_;
   int16_t tbeam_index_;
@@ -240,6 +604,20 @@ private:
   TClonesArray parts_;
   int16_t rc_n_part_{0};
   TClonesArray rc_parts_;
+  // a resumed tree needs the address of a pointer to the particle buffers
+  TClonesArray* parts_ptr_{&parts_};
+  TClonesArray* rc_parts_ptr_{&rc_parts_};
+  // or in columns
+  const particle_layout layout_;
+  particle_columns part_cols_;
+  particle_columns rc_part_cols_;
+
+  // output timing
+  stage_timing timing_;
+  const size_t stage_tree_{timing_.stage("output_tree")};
+  const size_t stage_hepmc_{timing_.stage("output_hepmc")};
+  const size_t stage_gemc_{timing_.stage("output_gemc")};
+  const size_t stage_simc_{timing_.stage("output_simc")};
 };
 } // namespace lager
 
@@ -280,7 +658,7 @@ inline int event::add_daughter(const std::pair<particle, particle>& daughters,
 inline void event::update_stat(const size_t evgen, const double txs) {
   evgen_ = evgen;
   total_cross_section_ = txs;
-  update_cross_section(jacobian());
+  apply_jacobian();
   process_cross_section_ = 0.; // not used anymore
 }
 inline void event::update_process(const int proc) { process_ = proc; }
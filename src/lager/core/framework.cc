@@ -77,6 +77,20 @@ framework::framework(int argc, char* argv[],
   if (!lumi) {
     events = get_option<int>("events");
   }
+  // optional number of worker threads
+  if (args_.count("threads")) {
+    conf_.set("threads", args_["threads"].as<int>());
+  }
+  // optional checkpoint interval, and resume from the last checkpoint
+  if (args_.count("checkpoint")) {
+    conf_.set("checkpoint", args_["checkpoint"].as<double>());
+  }
+  const bool resume = args_.count("resume") > 0;
+  conf_.set("resume", resume);
+  // write the output from the main thread instead of a separate thread
+  if (args_.count("sync-output")) {
+    conf_.set("async_output", false);
+  }
 
   // output file name
 
@@ -122,8 +136,9 @@ framework::framework(int argc, char* argv[],
   write_json(output_ + ".json", settings);
 
   // redirect logger to use the log file
+  // (when resuming, we append to the existing log file)
   LOG_INFO("lager", "Redirecting logger to: " + output_ + ".log");
-  log_file_.open(output_ + ".log");
+  log_file_.open(output_ + ".log", resume ? std::ios::app : std::ios::out);
   global::logger.set_output(log_file_);
 
   // Communicate LAGER commit hash for this run
@@ -196,8 +211,14 @@ po::variables_map framework::parse_arguments(int argc, char* argv[]) const {
     opts_visible.add_options()("help,h", "Produce help message")(
         "conf,c", po::value<std::string>()->required()->notifier(file_exists),
         "Configuration JSON file")("run,r", po::value<int>(),
-                                   "Run number (also the random seed)")(
+                                   "Run number (also the random stream key)")(
         "events,e", po::value<int>(), "Number of events to generate")(
+        "threads,t", po::value<int>(),
+        "Number of worker threads (default: 1)")(
+        "checkpoint,k", po::value<double>(),
+        "Checkpoint interval in seconds (default: no checkpoints)")(
+        "resume", "Resume an interrupted run from its last checkpoint")(
+        "sync-output", "Write the output from the generation thread")(
         "verb,v",
         po::value<unsigned>()->default_value(
             static_cast<unsigned>(log_level::INFO)),
@@ -223,6 +244,12 @@ po::variables_map framework::parse_arguments(int argc, char* argv[]) const {
     if (args.count("verb")) {
       unsigned v{args["verb"].as<unsigned>()};
       LOG_INFO("lager", "Verbosity level: " + std::to_string(v));
+      if (v > static_cast<unsigned>(LOG_LEVEL_MAX)) {
+        LOG_WARNING("lager",
+                    "Messages above verbosity level " +
+                        std::to_string(static_cast<unsigned>(LOG_LEVEL_MAX)) +
+                        " are not available in this build");
+      }
       global::logger.set_level(v);
     }
     return args;
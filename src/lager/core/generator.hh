@@ -20,13 +20,18 @@
 #ifndef LAGER_CORE_GENERATOR_LOADED
 #define LAGER_CORE_GENERATOR_LOADED
 
-#include <TRandom.h>
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <lager/core/assert.hh>
 #include <lager/core/configuration.hh>
 #include <lager/core/factory.hh>
 #include <lager/core/interval.hh>
+#include <lager/core/random.hh>
+#include <lager/core/sampler.hh>
+#include <lager/core/timer.hh>
 #include <memory>
+#include <vector>
 
 namespace lager {
 
@@ -42,6 +47,11 @@ public:
 
   void update_cross_section(const double xs) { cross_section_ *= xs; }
   void update_jacobian(const double j) { jacobian_ *= j; }
+  // fold the jacobian into the cross section (safe to call more than once)
+  void apply_jacobian() {
+    cross_section_ *= jacobian_;
+    jacobian_ = 1.;
+  }
 
 private:
   double cross_section_;
@@ -52,13 +62,14 @@ private:
 // =============================================================================
 // Base class for all generators
 //
-// Owns a shared pointer to the random generator.
+// Owns a shared pointer to the random generator, which is accessed by
+// reference.
 // =============================================================================
 template <class Data, class... Input> class generator {
 public:
   using data_type = Data;
 
-  generator(std::shared_ptr<TRandom> r) : rng_{std::move(r)} {}
+  generator(std::shared_ptr<random_engine> r) : rng_{std::move(r)} {}
 
   // generate an event
   virtual data_type generate(const Input&... input) = 0;
@@ -71,7 +82,9 @@ public:
 
 protected:
   // access the RNG
-  std::shared_ptr<TRandom> rng() const { return rng_; }
+  random_engine& rng() const { return *rng_; }
+  // shared RNG pointer, used to initialize sub-generators
+  std::shared_ptr<random_engine> shared_rng() const { return rng_; }
 
   // generate a random number following an arbitrary function
   // parameters:
@@ -82,41 +95,66 @@ protected:
   // cross section estimate
   template <class Func1D>
   double rand_f(const interval<double>& range, Func1D f, double fmax) const {
-    const double x = rng()->Uniform(range.min, range.max);
-    const double test = rng()->Uniform(0, fmax);
-    const double fx = f(x);
-    // if the test fails, try again (accept-reject)
-    if (test > fx) {
-      return rand_f(range, f, fmax);
-    }
-    // ensure a proper fmax
-    tassert(fx <= fmax, "fmax set too small in rand_f call");
-
-    return x;
+    return accept_reject(rng(), range, f, fmax);
   }
   // same for 2D functions
   template <class Func2D>
   std::pair<double, double> rand_f(const interval<double>& range1,
                                    const interval<double>& range2, Func2D f,
                                    double fmax) const {
-    const double x = rng()->Uniform(range1.min, range1.max);
-    const double y = rng()->Uniform(range2.min, range2.max);
-    const double test = rng()->Uniform(0, fmax);
-    const double fxy = f(x, y);
-    // if the test fails, try again (accept-reject)
-    if (test > fxy) {
-      return rand_f(range1, range2, f, fmax);
-    }
-    // ensure a proper fmax
-    tassert(fxy <= fmax, "fmax set too small in rand_f call (" +
-                             std::to_string(fxy) + ">" + std::to_string(fmax) +
-                             ")");
-    return {x, y};
+    return accept_reject(rng(), range1, range2, f, fmax);
+  }
+  // sample from a tabulated function (for fixed functions that are sampled
+  // often, see core/sampler.hh)
+  double rand_f(const inverse_cdf& table) const {
+    return table.generate(rng());
   }
 
 private:
-  std::shared_ptr<TRandom> rng_;
+  std::shared_ptr<random_engine> rng_;
+};
+
+// =============================================================================
+// Block of initial states for the batched process generator interface
+//
+// Stores the initial states of a block of trials. Derive from this class to
+// also provide the initial state kinematics as a structure-of-arrays, so that
+// process generators can evaluate their cross section for the full block in
+// (vectorizable) loops.
+//
+// Note: the derived class should hide clear() and push_back(), and call the
+//       base class versions from within
+// =============================================================================
+template <class InitialData> class initial_block {
+public:
+  using initial_type = InitialData;
+
+  size_t size() const { return data_.size(); }
+  bool empty() const { return data_.empty(); }
+  void clear() { data_.clear(); }
+  void push_back(const initial_type& initial) { data_.push_back(initial); }
+
+  const initial_type& operator[](const size_t i) const { return data_[i]; }
+
+private:
+  std::vector<initial_type> data_;
+};
+
+// =============================================================================
+// Reasons why a trial for a process does not result in an event, counted per
+// process by the event generator (trials without a valid initial state are
+// counted separately, as they happen before a process is selected)
+// =============================================================================
+enum class rejection : unsigned {
+  THRESHOLD = 0,     // below the production threshold
+  T_RANGE = 1,       // t outside of the kinematically allowed range
+  CROSS_SECTION = 2, // any other zero cross section (e.g. W2 range)
+  ACCEPT_REJECT = 3, // rejected in the accept-reject step
+  EVENT_BUILDER = 4  // zero weight after the event builder (reconstruction)
 };
+constexpr std::array<const char*, 5> REJECTION_NAMES{
+    "threshold", "t_range", "cross_section", "accept_reject", "event_builder"};
+constexpr size_t N_REJECTION{REJECTION_NAMES.size()};
 
 // =============================================================================
 // Base class for all process_generators
@@ -124,30 +162,88 @@ private:
 // Generator input: initial reaction information
 // Generator output: a valid event
 //
+// The event generator evaluates the trials in blocks through the batched
+// interface:
+//    * evaluate(block, xs): generate a phase space point and evaluate the
+//      cross section for every lane in the block (xs <= 0 for failed trials)
+//    * build(block, lane): build the event for an evaluated (and accepted)
+//      lane of the last evaluated block
+// Process generators implement both members, so that evaluate() only does the
+// work needed for the cross section (ideally in a loop without early exits or
+// logging, so it can be vectorized), and the (expensive) event building is
+// deferred to build(). evaluate() can report why a lane failed with
+// reject(lane, reason), lanes with a zero cross section count as
+// rejection::CROSS_SECTION otherwise.
+//
+// generate() is implemented on top of the batched interface, as a block of a
+// single trial.
+//
 // Note:
 //    * Event should derive from the event class (in core/event.hh)
 //    * InitialData should derive from generator_data
+//    * Block should derive from initial_block<InitialData>
 // =============================================================================
-template <class Event, class InitialData>
+template <class Event, class InitialData,
+          class Block = initial_block<InitialData>>
 class process_generator : public generator<Event, InitialData> {
 public:
   using event_type = Event;
   using initial_type = InitialData;
+  using block_type = Block;
   using base_type = generator<Event, InitialData>;
 
   static factory<process_generator, const configuration&, const string_path&,
-                 std::shared_ptr<TRandom>>
+                 std::shared_ptr<random_engine>>
       factory_instance;
 
-  process_generator(std::shared_ptr<TRandom> r) : base_type{std::move(r)} {}
+  process_generator(std::shared_ptr<random_engine> r)
+      : base_type{std::move(r)} {}
+
+  // evaluate and build a single trial. This uses the same scratch space as
+  // the batched interface, so it invalidates the last evaluated block.
+  event_type generate(const initial_type& initial) final {
+    single_.clear();
+    single_.push_back(initial);
+    reset_rejected(1);
+    evaluate(single_, single_xs_);
+    if (single_xs_[0] <= 0) {
+      return event_type{0.};
+    }
+    return build(single_, 0);
+  }
+
+  // batched interface
+  virtual void evaluate(const block_type& block, std::vector<double>& xs) = 0;
+  virtual event_type build(const block_type& block, const size_t lane) = 0;
 
-  virtual event_type generate(const initial_type&) = 0;
+  // rejection reason for a failed lane of the last evaluated block, reset by
+  // the event generator before every evaluate() call
+  rejection rejected(const size_t lane) const { return rejected_[lane]; }
+  void reset_rejected(const size_t n) {
+    rejected_.assign(n, rejection::CROSS_SECTION);
+  }
+
+protected:
+  // record the rejection reason for a lane (ignored outside of a batched
+  // evaluate() call, where no reasons are tracked)
+  void reject(const size_t lane, const rejection reason) {
+    if (lane < rejected_.size()) {
+      rejected_[lane] = reason;
+    }
+  }
+
+private:
+  // block and cross section for generate()
+  block_type single_;
+  std::vector<double> single_xs_;
+  // rejection reasons for the last evaluated block
+  std::vector<rejection> rejected_;
 };
 
-template <class Event, class InitialData>
-factory<process_generator<Event, InitialData>, const configuration&,
-        const string_path&, std::shared_ptr<TRandom>>
-    process_generator<Event, InitialData>::factory_instance;
+template <class Event, class InitialData, class Block>
+factory<process_generator<Event, InitialData, Block>, const configuration&,
+        const string_path&, std::shared_ptr<random_engine>>
+    process_generator<Event, InitialData, Block>::factory_instance;
 
 // =============================================================================
 // Base class for all event_processors (detectors/decay_handlers/...)
@@ -162,7 +258,7 @@ public:
   using event_type = Event;
   using base_type = generator<void>;
 
-  event_processor(std::shared_ptr<TRandom> r) : base_type{std::move(r)} {}
+  event_processor(std::shared_ptr<random_engine> r) : base_type{std::move(r)} {}
 
   virtual void process(event_type&) const = 0;
 
@@ -174,10 +270,12 @@ private:
 
 // =============================================================================
 // Base class for event generators that handle the following steps:
-//    * generate initial state
-//    * evaluate all processes (up to 10) simulataneously
+//    * generate a block of initial states, and select one of the processes
+//      (up to 10) for every trial, with a probability proportional to the
+//      process generation volume
+//    * evaluate each process for the trials it was selected for
 //    * accept-reject each process
-//    * event building for each process
+//    * event building for each accepted trial
 // Keeps track of the generated cross section
 //
 // Usage:
@@ -191,25 +289,138 @@ private:
 // Note:
 //    * Event should derive from the event class (in core/event.hh)
 //    * InitialData should derive from generator_data
+//    * Block should derive from initial_block<InitialData>
+//    * all trials in a block are generated (and counted) before the events
+//      are returned, the block size can be set with
+//      generator/advanced/block_size
+//    * with generator/mode set to "weighted", the accept-reject step is
+//      skipped and every trial with a positive cross section is kept. The
+//      event weight is then the cross section divided by the proposal density
+//      (i.e. times the generation phase space, divided by the process
+//      selection probability), in nb, and the cross section is the sum of
+//      the weights divided by the number of trials.
+//    * generation stops after the requested number of events (or luminosity),
+//      or as soon as the optional precision/relative target is reached on the
+//      total cross section (or on every process cross section with
+//      precision/per_process set), after at least precision/min_trials
+//      trials.
 // =============================================================================
-template <class Event, class InitialData>
+template <class Event, class InitialData,
+          class Block = initial_block<InitialData>>
 class event_generator : public generator<std::vector<Event>>,
                         public configurable {
 public:
   using event_type = Event;
   using initial_type = InitialData;
+  using block_type = Block;
   using base_type = generator<std::vector<Event>>;
-  using process_type = process_generator<event_type, initial_type>;
+  using process_type = process_generator<event_type, initial_type, block_type>;
+
+  enum class generation_mode { UNWEIGHTED, WEIGHTED };
+
+  // per-process counters: trials for which the process was selected, and
+  // accepted events (with the sum of their weights and squared weights). Also
+  // counts the rejected trials for every rejection reason, and the trials
+  // that exceeded the cross section maximum.
+  struct process_statistics {
+    double n_trials{0.};
+    double n_events{0.};
+    double sum_weights{0.};
+    double sum_weights2{0.};
+    std::array<double, N_REJECTION> n_rejected{};
+    double n_max_exceeded{0.};
+
+    process_statistics operator-(const process_statistics& rhs) const {
+      process_statistics delta{n_trials - rhs.n_trials,
+                               n_events - rhs.n_events,
+                               sum_weights - rhs.sum_weights,
+                               sum_weights2 - rhs.sum_weights2};
+      for (size_t i = 0; i < N_REJECTION; ++i) {
+        delta.n_rejected[i] = n_rejected[i] - rhs.n_rejected[i];
+      }
+      delta.n_max_exceeded = n_max_exceeded - rhs.n_max_exceeded;
+      return delta;
+    }
+    process_statistics& operator+=(const process_statistics& rhs) {
+      n_trials += rhs.n_trials;
+      n_events += rhs.n_events;
+      sum_weights += rhs.sum_weights;
+      sum_weights2 += rhs.sum_weights2;
+      for (size_t i = 0; i < N_REJECTION; ++i) {
+        n_rejected[i] += rhs.n_rejected[i];
+      }
+      n_max_exceeded += rhs.n_max_exceeded;
+      return *this;
+    }
+  };
+
+  // generation statistics, kept separate so the counters of independent
+  // generator clones (e.g. one per worker thread) can be merged into a single
+  // cross section estimate. The per-process counters are optional when
+  // merging (i.e. they are ignored when empty). The branching ratio is only
+  // taken from a delta that contains events.
+  struct statistics {
+    double n_trials{0.};
+    double n_events{0.};
+    double n_gen_events{0.};
+    double branching_ratio{1.};
+    double sum_weights{0.};
+    double sum_weights2{0.};
+    std::vector<process_statistics> processes;
+    double n_rejected_initial{0.}; // trials without a valid initial state
+
+    statistics operator-(const statistics& rhs) const {
+      statistics delta{n_trials - rhs.n_trials,
+                       n_events - rhs.n_events,
+                       n_gen_events - rhs.n_gen_events,
+                       branching_ratio,
+                       sum_weights - rhs.sum_weights,
+                       sum_weights2 - rhs.sum_weights2,
+                       processes,
+                       n_rejected_initial - rhs.n_rejected_initial};
+      for (size_t i = 0; i < rhs.processes.size(); ++i) {
+        delta.processes[i] = processes[i] - rhs.processes[i];
+      }
+      return delta;
+    }
+    statistics& operator+=(const statistics& delta) {
+      n_trials += delta.n_trials;
+      n_events += delta.n_events;
+      n_gen_events += delta.n_gen_events;
+      sum_weights += delta.sum_weights;
+      sum_weights2 += delta.sum_weights2;
+      n_rejected_initial += delta.n_rejected_initial;
+      if (delta.n_events > 0) {
+        branching_ratio = delta.branching_ratio;
+      }
+      for (size_t i = 0; i < delta.processes.size(); ++i) {
+        processes[i] += delta.processes[i];
+      }
+      return *this;
+    }
+  };
 
   event_generator(const configuration& cf, const string_path& path,
-                  std::shared_ptr<TRandom> r)
+                  std::shared_ptr<random_engine> r)
       : base_type{std::move(r)}
       , configurable{cf, path}
-      , penalty_{cf.get<double>(path / "advanced/penalty", 1.0)} {
+      , mode_{cf.get<generation_mode>(path / "mode",
+                                      generation_mode::UNWEIGHTED,
+                                      mode_translator())}
+      , penalty_{cf.get<double>(path / "advanced/penalty", 1.0)}
+      , block_size_{cf.get<int>(path / "advanced/block_size", 64)} {
+    tassert(block_size_ > 0, "advanced/block_size should be at least 1");
     init_process_list();
+    init_process_table();
     init_lumi(cf);
+    init_precision(cf);
+    init_timing(cf);
+    LOG_INFO("event_generator",
+             std::string("mode: ") + (weighted() ? "weighted" : "unweighted"));
     LOG_INFO("event_generator",
              "advanced/penalty: " + std::to_string(penalty_));
+    LOG_INFO("event_generator",
+             "advanced/block_size: " + std::to_string(block_size_));
   }
 
   virtual std::vector<event_type> generate() {
@@ -221,93 +432,88 @@ public:
     std::vector<event_type> good_event_list;
     do {
 
-      // generate a phase space point
-      std::vector<event_type> event_list;
+      // generate a block of phase space points (the buffers are members, so
+      // they keep their capacity between calls)
+      auto& event_list = block_events_;
+      auto& weight_list = block_weights_;
+      auto& process_index_list = block_process_;
+      event_list.clear();
+      weight_list.clear();
+      process_index_list.clear();
       do {
-        n_trials_ += 1;
-        auto initial = generate_initial();
-        // start over if we already have a bad initial state
-        if (initial.cross_section() <= 0) {
-          LOG_JUNK("event_generator",
-                   "Initial cross section <= 0, abandoning trial cycle.");
-          continue;
-        }
-        LOG_JUNK("event_generator",
-                 "Initial cross section: " +
-                     std::to_string(initial.cross_section()));
-        // generate the sub_processes
+        generate_block();
+        // evaluate the sub_processes for the trials they were selected for
         for (auto& process : process_list_) {
-          LOG_JUNK(process.name, "Generating a trial event");
-          // check if we need to generate an event for this process (ensure
-          // correct sub-process mixing)
-          if (proc_volume_ != process.vol &&
-              this->rng()->Uniform(0, proc_volume_) > process.vol) {
-            LOG_JUNK(process.name, "Skipping this trial cycle.");
+          if (process.block.empty()) {
             continue;
           }
-          // generate one event
-          auto event = process.gen->generate(initial);
-          // go to the next process have a bad cross section, print a warning
-          // if the cross section maximum was violated
-          if (event.cross_section() <= 0) {
-            LOG_JUNK(process.name,
-                     "Cross section <= 0, skipping this trial cycle");
-            continue;
-          } else if (event.cross_section() >
-                     initial_max_ * process.max * penalty_) {
-            LOG_WARNING(
-                process.name,
-                "Cross section maximum exceeded (" +
-                    std::to_string(event.cross_section()) + " > " +
-                    std::to_string(initial_max_ * process.max * penalty_) +
-                    "), the distributions will be invalid if this "
-                    "happens too often.");
-            LOG_WARNING(
-                process.name,
-                "To mitigate, either increase "
-                "the configuration paramater generator/advanced/penalty "
-                "(which gets multiplied with the cross section maximum "
-                "during the accept-reject step), or fix the cross "
-                "section maximum estimation in the actual Physics "
-                "module.");
+          LOG_JUNK(process.name, "Evaluating a block of " +
+                                     std::to_string(process.block.size()) +
+                                     " trial events");
+          {
+            scoped_timer t{timing_, stage_evaluate_, process.id};
+            process.gen->reset_rejected(process.block.size());
+            process.gen->evaluate(process.block, process.xs);
           }
-          // accept/reject this event
-          LOG_JUNK(process.name,
-                   "Testing accept reject for xs: " +
-                       std::to_string(event.cross_section()) + " (max: " +
-                       std::to_string(process.max * initial_max_) + ")");
-          if (this->rng()->Uniform(0, initial_max_ * process.max * penalty_) <
-              event.cross_section()) {
-            LOG_JUNK(process.name, "Event accepted!");
-            event.update_process(process.id);
-            event_list.push_back(event);
-            n_gen_events_ += 1;
+          scoped_timer t{timing_, stage_accept_, process.id};
+          if (weighted()) {
+            select(process);
           } else {
-            LOG_JUNK(process.name, "Event rejected.");
+            accept_reject(process);
+          }
+        }
+        // build the accepted events, in the order of the trials
+        for (size_t i = 0; i < trial_process_.size(); ++i) {
+          auto& process = process_list_[trial_process_[i]];
+          const size_t lane = trial_lane_[i];
+          if (process.accept[lane]) {
+            scoped_timer t{timing_, stage_build_, process.id};
+            auto event = process.gen->build(process.block, lane);
+            event.update_process(process.id);
+            event.update_unit(this->rng().index());
+            event_list.push_back(std::move(event));
+            weight_list.push_back(weighted() ? process.weight[lane] : 1.);
+            process_index_list.push_back(trial_process_[i]);
+            stats_.n_gen_events += 1;
           }
         }
       } while (event_list.empty());
 
-      for (auto& event : event_list) {
+      for (size_t i = 0; i < event_list.size(); ++i) {
+        auto& event = event_list[i];
         LOG_JUNK("generator", "Processing event (process " +
                                   std::to_string(event.process()) + ")");
-        build_event(event);
+        {
+          scoped_timer t{timing_, stage_event_builder_, event.process()};
+          build_event(event);
+        }
         if (event.weight() > 0) {
           LOG_JUNK("generator",
                    "Event accepted after event builder step (weight: " +
-                       std::to_string(event.weight()) + ", reset to 1)");
-          n_events_ += 1;
+                       std::to_string(event.weight()) + ", reset to " +
+                       std::to_string(weight_list[i]) + ")");
+          const double w = weight_list[i];
+          auto& process = stats_.processes[process_index_list[i]];
+          stats_.n_events += 1;
+          stats_.sum_weights += w;
+          stats_.sum_weights2 += w * w;
+          process.n_events += 1;
+          process.sum_weights += w;
+          process.sum_weights2 += w * w;
           // update BR, assumed to be same for all events!
           // TODO this is really a design issue and should be fixed for a next
           //      major release
-          branching_ratio_ = event.weight();
-          event.update_stat(static_cast<size_t>(n_events_), cross_section());
-          event.reset_weight();
-          good_event_list.push_back(event);
+          stats_.branching_ratio = event.weight();
+          event.update_stat(static_cast<size_t>(stats_.n_events),
+                            cross_section());
+          event.reset_weight(weight_list[i]);
+          good_event_list.push_back(std::move(event));
         } else {
           LOG_JUNK("generator",
                    "Event rejected after event builder step (weight: " +
                        std::to_string(event.weight()) + ")");
+          count_rejected(process_list_[process_index_list[i]],
+                         rejection::EVENT_BUILDER);
         }
       }
       // ensure we actually have an event, else start over
@@ -320,41 +526,160 @@ public:
   // (phase_space * max_cross_section) times the fraction of accepted events
   // compared to the number of trials
   //
-  // THis is true for all processes, as we rescaled the number of trials T2
-  // for a process with less generation volume V2 compared to the prime
-  // process by a factor of V2/V1, i.e. T2 = V2/V1 * T1
+  // This is true for all processes, as every trial selects a single process
+  // i with probability V_i/V, where V is the sum of all process generation
+  // volumes. The number of trials for process i is then T_i = V_i/V * T
   //
   // Therefore we get that
-  // sigma_2 = G2 / T2 * V2 = G2 / T1 * V1
+  // sigma_i = G_i / T_i * V_i = G_i / T * V
   //
   // n_tot_events is the sum of all the generated events in all subprocesses,
-  // hence we obtain sigma_tot = sum_i sigma_i = sum_i G_i * V1/T1
-  double cross_section() const {
+  // hence we obtain sigma_tot = sum_i sigma_i = sum_i G_i * V/T
+  //
+  // In weighted mode, the event weights already account for the process
+  // selection probability, and the cross section is the sum of the event
+  // weights divided by the number of trials
+  //
+  // The statistical uncertainty follows from the binomial distribution of G
+  // (out of T trials), or from the variance of the weights in weighted mode.
+  //
+  // All estimates are also available for statistics gathered elsewhere (e.g.
+  // merged from independent clones of this generator, see
+  // threaded_generator). They only depend on the generator settings, which are
+  // fixed after the construction.
+  double cross_section() const { return cross_section(stats_); }
+  double cross_section_error() const { return cross_section_error(stats_); }
+  double partial_cross_section() const {
+    return partial_cross_section(stats_);
+  }
+  double partial_cross_section_error() const {
+    return partial_cross_section_error(stats_);
+  }
+  double cross_section(const statistics& s) const {
     // return a safe upper boundary in case we don't have enough events yet to
     // have some kind of reasonable estimate
-    if (n_events_ < 50) {
-      return volume_ * process_list_.size();
+    if (s.n_events < MIN_EVENTS_ESTIMATE) {
+      return volume_;
     }
     // the actual cross section estimate
-    return volume_ * n_events() / n_trials_;
+    return estimate(s.n_trials, s.n_events, s.sum_weights);
   }
-  double partial_cross_section() const {
-    return cross_section() * branching_ratio_;
+  double cross_section_error(const statistics& s) const {
+    // 100% uncertainty on our upper boundary
+    if (s.n_events < MIN_EVENTS_ESTIMATE) {
+      return cross_section(s);
+    }
+    return estimate_error(s.n_trials, s.n_events, s.sum_weights,
+                          s.sum_weights2);
+  }
+  double partial_cross_section(const statistics& s) const {
+    return cross_section(s) * s.branching_ratio;
+  }
+  double partial_cross_section_error(const statistics& s) const {
+    return cross_section_error(s) * s.branching_ratio;
+  }
+
+  // per-process breakdown, with the processes in the order of the
+  // configuration file
+  size_t n_processes() const { return process_list_.size(); }
+  const std::string& process_name(const size_t i) const {
+    return process_list_[i].name;
+  }
+  double process_n_trials(const size_t i) const {
+    return stats_.processes[i].n_trials;
   }
-  int64_t n_events() const { return n_events_; }
+  double process_n_events(const size_t i) const {
+    return stats_.processes[i].n_events;
+  }
+  // number of rejected trials for a process and rejection reason, and the
+  // number of trials that exceeded the cross section maximum
+  double process_n_rejected(const size_t i, const rejection reason) const {
+    return stats_.processes[i].n_rejected[static_cast<size_t>(reason)];
+  }
+  double process_n_max_exceeded(const size_t i) const {
+    return stats_.processes[i].n_max_exceeded;
+  }
+  // number of trials without a valid initial state (before process selection)
+  double n_rejected_initial() const { return stats_.n_rejected_initial; }
+  double process_cross_section(const size_t i) const {
+    return process_cross_section(stats_, i);
+  }
+  double process_cross_section_error(const size_t i) const {
+    return process_cross_section_error(stats_, i);
+  }
+  double process_cross_section(const statistics& s, const size_t i) const {
+    const auto& process = s.processes[i];
+    return estimate(s.n_trials, process.n_events, process.sum_weights);
+  }
+  double process_cross_section_error(const statistics& s,
+                                     const size_t i) const {
+    const auto& process = s.processes[i];
+    return estimate_error(s.n_trials, process.n_events, process.sum_weights,
+                          process.sum_weights2);
+  }
+  int64_t n_events() const { return static_cast<int64_t>(stats_.n_events); }
+  double n_trials() const { return stats_.n_trials; }
+  // total generation volume (phase space times cross section maximum of all
+  // processes), fixed after the construction
+  double volume() const { return volume_; }
   // return the acceptance, i.e., the number of events divided by the number
   // of generated events before the event builder step
-  double acceptance() const { return double(n_events_) / n_gen_events_; }
+  double acceptance() const { return acceptance(stats_); }
+  double acceptance(const statistics& s) const {
+    return s.n_events / s.n_gen_events;
+  }
 
   // calculate the number of requested events from the lumi * cross section *
   // branching ratio, or alternatively use the fixed number of events
-  int64_t n_requested() const {
+  int64_t n_requested() const { return n_requested(stats_); }
+  int64_t n_requested(const statistics& s) const {
     return (n_requested_ > 0) ? n_requested_
                               : static_cast<int64_t>(std::round(
-                                    lumi_ * partial_cross_section()));
+                                    lumi_ * partial_cross_section(s)));
   }
 
-  bool finished() const { return (n_events() >= n_requested()); }
+  bool finished() const {
+    return (n_events() >= n_requested()) || precision_reached();
+  }
+
+  // check if the requested relative precision on the cross section was
+  // reached (always false if no precision was requested)
+  bool precision_reached() const { return precision_reached(stats_); }
+  bool precision_reached(const statistics& s) const {
+    if (precision_ <= 0 || s.n_trials < min_trials_ ||
+        s.n_events < MIN_EVENTS_ESTIMATE) {
+      return false;
+    }
+    if (!precision_per_process_) {
+      return cross_section_error(s) <= precision_ * cross_section(s);
+    }
+    for (size_t i = 0; i < process_list_.size(); ++i) {
+      const double xs = process_cross_section(s, i);
+      if (xs <= 0 || process_cross_section_error(s, i) > precision_ * xs) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool weighted() const { return mode_ == generation_mode::WEIGHTED; }
+
+  // position the RNG at the start of work unit "index". Generating the same
+  // sequence of work units always results in the same events.
+  // Also enables the timing trace for sampled work units.
+  void seek(const uint64_t index) {
+    this->rng().seek(index);
+    timing_.trace(trace_interval_ > 0 && index % trace_interval_ == 0);
+  }
+
+  // time spent in the generation stages (for this clone). Child classes can
+  // add their own stages. The timing is not part of the generator state, so
+  // it can also be updated from const members.
+  stage_timing& timing() const { return timing_; }
+
+  // access the generation statistics (e.g. to merge the counters of a work
+  // unit into a global estimate)
+  const statistics& stats() const { return stats_; }
 
 protected:
   // GENERATION STEPS
@@ -382,22 +707,176 @@ protected:
 
 private:
   constexpr static const int N_MAX_PROC{10}; // maximum number of sub processes;
+  // minimum number of events for a cross section estimate
+  constexpr static const int MIN_EVENTS_ESTIMATE{50};
   constexpr static const char* PROC_KEY{"process_"}; // config file key
   static std::string process_id(const int i) {
     return PROC_KEY + std::to_string(i);
   }
 
+  // process info (the per-process statistics are part of stats_)
+  struct process_info {
+    const size_t index;                // index in the process list
+    const int id;                      // process identifier
+    const std::string name;            // process name
+    double ps{0};                      // process dependent phase space
+    double max{0};                     // max cross section
+    double vol{0};                     // generation volume
+    std::shared_ptr<process_type> gen; // process sub-generator
+    std::vector<char> accept;          // accept mask for the current block
+    std::vector<double> weight;        // event weights (weighted mode only)
+    block_type block;                  // trials selected for this process
+    std::vector<double> xs;            // cross sections for the block
+    process_info(const size_t index, const int id,
+                 std::shared_ptr<process_type> g)
+        : index{index}
+        , id{id}
+        , name{process_id(id)}
+        , ps{g->phase_space()}
+        , max{g->max_cross_section()}
+        , vol{max * ps}
+        , gen{g} {}
+  };
+
   // the maximum cross section and total phase space volume functions
   // don't make sense here, as they are different for each of the
   // sub-processes
   virtual double max_cross_section() const { return -1; }
   virtual double phase_space() const { return -1; }
 
+  // cross section estimate and its statistical uncertainty after t trials,
+  // from a number of events n (unweighted) or the sum of the (squared) event
+  // weights sw and sw2 (weighted)
+  double estimate(const double t, const double n, const double sw) const {
+    if (t <= 0) {
+      return 0;
+    }
+    return weighted() ? sw / t : volume_ * n / t;
+  }
+  double estimate_error(const double t, const double n, const double sw,
+                        const double sw2) const {
+    if (t <= 0) {
+      return 0;
+    }
+    if (weighted()) {
+      return std::sqrt(std::max(0., sw2 - sw * sw / t)) / t;
+    }
+    return volume_ * std::sqrt(std::max(0., n * (1. - n / t))) / t;
+  }
+
   // update the total generation volume
   void update_volume() {
     volume_ = initial_ps_ * initial_max_ * proc_volume_ * penalty_;
   }
 
+  // fill the process blocks with valid initial states, every initial state
+  // counts as a trial
+  void generate_block() {
+    for (auto& process : process_list_) {
+      process.block.clear();
+    }
+    trial_process_.clear();
+    trial_lane_.clear();
+    // the block is timed as a whole and counted as one call per trial, a
+    // timer per trial would cost as much as a simple initial state
+    const auto start = stage_timing::clock::now();
+    const double n_trials_start = stats_.n_trials;
+    while (trial_process_.size() < static_cast<size_t>(block_size_)) {
+      stats_.n_trials += 1;
+      auto initial = generate_initial();
+      // start over if we already have a bad initial state
+      if (initial.cross_section() <= 0) {
+        LOG_JUNK("event_generator",
+                 "Initial cross section <= 0, abandoning trial cycle.");
+        stats_.n_rejected_initial += 1;
+        continue;
+      }
+      const size_t ip = select_process();
+      stats_.processes[ip].n_trials += 1;
+      trial_process_.push_back(ip);
+      trial_lane_.push_back(process_list_[ip].block.size());
+      process_list_[ip].block.push_back(initial);
+    }
+    timing_.add(stage_initial_, -1, start, stage_timing::clock::now(),
+                static_cast<uint64_t>(stats_.n_trials - n_trials_start));
+  }
+
+  // select a process with a probability proportional to its generation
+  // volume (ensures correct sub-process mixing)
+  size_t select_process() {
+    if (!process_table_) {
+      return 0;
+    }
+    return process_table_->generate(this->rng());
+  }
+
+  // count a rejected trial for a process
+  void count_rejected(const process_info& process, const rejection reason) {
+    stats_.processes[process.index].n_rejected[static_cast<size_t>(reason)] +=
+        1;
+  }
+
+  // accept-reject step for the last evaluated block of a process, stores
+  // the accept mask with the process info
+  void accept_reject(process_info& process) {
+    const double xs_max = initial_max_ * process.max * penalty_;
+    const auto& xs = process.xs;
+    process.accept.assign(process.block.size(), 0);
+    for (size_t i = 0; i < process.block.size(); ++i) {
+      // skip trials with a bad cross section, print a warning if the cross
+      // section maximum was violated
+      if (xs[i] <= 0) {
+        count_rejected(process, process.gen->rejected(i));
+        continue;
+      } else if (xs[i] > xs_max) {
+        stats_.processes[process.index].n_max_exceeded += 1;
+        LOG_WARNING(process.name,
+                    "Cross section maximum exceeded (" +
+                        std::to_string(xs[i]) + " > " +
+                        std::to_string(xs_max) +
+                        "), the distributions will be invalid if this "
+                        "happens too often.");
+        LOG_WARNING(process.name,
+                    "To mitigate, either increase "
+                    "the configuration paramater generator/advanced/penalty "
+                    "(which gets multiplied with the cross section maximum "
+                    "during the accept-reject step), or fix the cross "
+                    "section maximum estimation in the actual Physics "
+                    "module.");
+      }
+      // accept/reject this trial
+      process.accept[i] = this->rng().Uniform(0, xs_max) < xs[i];
+      if (!process.accept[i]) {
+        count_rejected(process, rejection::ACCEPT_REJECT);
+      }
+    }
+  }
+
+  // weighted mode: keep all trials with a positive cross section for this
+  // process, the weight is the cross section times the generation phase
+  // space, divided by the probability to select this process
+  void select(process_info& process) {
+    const double ps = initial_ps_ * process.ps * proc_volume_ / process.vol;
+    const auto& xs = process.xs;
+    process.accept.assign(process.block.size(), 0);
+    process.weight.assign(process.block.size(), 0.);
+    for (size_t i = 0; i < process.block.size(); ++i) {
+      if (xs[i] > 0) {
+        process.accept[i] = 1;
+        process.weight[i] = xs[i] * ps;
+      } else {
+        count_rejected(process, process.gen->rejected(i));
+      }
+    }
+  }
+
+  static const translation_map<generation_mode>& mode_translator() {
+    static const translation_map<generation_mode> tr{
+        {"unweighted", generation_mode::UNWEIGHTED},
+        {"weighted", generation_mode::WEIGHTED}};
+    return tr;
+  }
+
   // initialize the process list
   // the factory will construct a new process generator for each of the
   // configuration file entries
@@ -413,26 +892,41 @@ private:
         LOG_DEBUG(path.str(),
                   "HK is Creating a new process sub-generator (" + *type + ")");
         process_list_.push_back(
-            {i, FACTORY_CREATE(process_type, cf, path, this->rng())});
+            {process_list_.size(), i,
+             FACTORY_CREATE(process_type, cf, path, this->shared_rng())});
         LOG_DEBUG(path.str(), "Cross section max: " +
                                   std::to_string(process_list_.back().max));
         LOG_DEBUG(path.str(),
                   "Phase space: " + std::to_string(process_list_.back().ps));
-        // check if we have a larger generation volume, update if needed
+        // add to the total process generation volume
         const double volume = process_list_.back().vol;
-        if (volume > proc_volume_) {
-          LOG_DEBUG("event_generator",
-                    "Updating maximum process generation volume: " +
-                        std::to_string(volume));
-          proc_volume_ = volume;
-          update_volume();
-        }
+        proc_volume_ += volume;
+        update_volume();
+        LOG_DEBUG("event_generator",
+                  "Updating total process generation volume: " +
+                      std::to_string(proc_volume_));
       } else {
         LOG_JUNK(path.str(), "Not requested");
       }
     }
     tassert(process_list_.size() > 0,
             "At least one process has to be specified");
+    stats_.processes.resize(process_list_.size());
+  }
+
+  // initialize the alias table for the process selection, not needed (and
+  // no random numbers are used) when there is only a single process
+  void init_process_table() {
+    if (process_list_.size() < 2) {
+      return;
+    }
+    std::vector<double> volumes;
+    for (const auto& process : process_list_) {
+      volumes.push_back(process.vol);
+      LOG_INFO(process.name, "Process selection probability: " +
+                                 std::to_string(process.vol / proc_volume_));
+    }
+    process_table_ = std::make_unique<alias_table>(volumes);
   }
 
   // init the number of requested events, or alternatively the requested
@@ -447,41 +941,87 @@ private:
       lumi_ = -1;
     }
   }
+  // init the optional precision target, the requested number of events (or
+  // luminosity) then acts as the upper limit
+  void init_precision(const configuration& cf) {
+    precision_ = cf.get<double>("precision/relative", -1.);
+    if (precision_ <= 0) {
+      return;
+    }
+    precision_per_process_ = cf.get<bool>("precision/per_process", false);
+    min_trials_ = cf.get<double>("precision/min_trials", 0.);
+    LOG_INFO("event_generator",
+             "precision/relative: " + std::to_string(precision_));
+    LOG_INFO("event_generator",
+             "precision/per_process: " +
+                 std::string(precision_per_process_ ? "true" : "false"));
+    LOG_INFO("event_generator",
+             "precision/min_trials: " + std::to_string(min_trials_));
+  }
 
-  struct process_info {
-    const int id;                      // process identifier
-    const std::string name;            // process name
-    double ps{0};                      // process dependent phase space
-    double max{0};                     // max cross section
-    double vol{0};                     // generation volume
-    double n_events{0};                // number of events
-    std::shared_ptr<process_type> gen; // process sub-generator
-    process_info(const int id, std::shared_ptr<process_type> g)
-        : id{id}
-        , name{process_id(id)}
-        , ps{g->phase_space()}
-        , max{g->max_cross_section()}
-        , vol{max * ps}
-        , gen{g} {}
-  };
+  // register the generation stages for the timing, and init the optional
+  // timing trace (one out of every timing/trace_interval work units)
+  void init_timing(const configuration& cf) {
+    stage_initial_ = timing_.stage("initial");
+    stage_evaluate_ = timing_.stage("evaluate");
+    stage_accept_ = timing_.stage("accept_reject");
+    stage_build_ = timing_.stage("build");
+    stage_event_builder_ = timing_.stage("event_builder");
+    for (const auto& process : process_list_) {
+      timing_.name_process(process.id, process.name);
+    }
+    trace_interval_ = cf.get<int>("timing/trace_interval", 0);
+    if (trace_interval_ > 0) {
+      LOG_INFO("event_generator", "timing/trace_interval: " +
+                                      std::to_string(trace_interval_));
+    }
+  }
+
+  // generation mode (unweighted or weighted events)
+  const generation_mode mode_;
 
   // advanced settings
-  const double penalty_; // AR max penalty factor
+  const double penalty_;  // AR max penalty factor
+  const int block_size_; // number of trials evaluated in one go
+
+  // selected process and lane in the process block for each trial in the
+  // current block
+  std::vector<size_t> trial_process_;
+  std::vector<size_t> trial_lane_;
+  // process selection proportional to the generation volume
+  std::unique_ptr<alias_table> process_table_;
+  // events built for the current block (before the event builder step), with
+  // their weights and process index
+  std::vector<event_type> block_events_;
+  std::vector<double> block_weights_;
+  std::vector<size_t> block_process_;
 
   // Generator state
   double initial_ps_{1.};   // initial state generator phase space
   double initial_max_{1.};  // initial state generator max cross section
-  double proc_volume_{-1.}; // largest generation volume in process_list
+  double proc_volume_{0.};  // total generation volume in process_list
   double volume_{1.};       // total volume
 
-  double n_trials_{0.};        // global trial counter
-  double n_events_{0};         // total number of events
-  double n_gen_events_{1};     // raw number of events before event builder step
-  double branching_ratio_{1.}; // constant branching ratio
+  // global and per-process counters (the raw number of events before the
+  // event builder step starts at 1)
+  statistics stats_{0., 0., 1.};
   std::vector<process_info> process_list_; // process dependent info
 
   int64_t n_requested_{-1}; // number of requested events
   double lumi_{-1}; // or alternatively, the requested luminosity (in fb^-1)
+  // optional precision target
+  double precision_{-1.};             // relative precision on the cross section
+  bool precision_per_process_{false}; // for every process instead of the total
+  double min_trials_{0.};             // minimum number of trials
+
+  // stage timing
+  mutable stage_timing timing_;
+  size_t stage_initial_{0};
+  size_t stage_evaluate_{0};
+  size_t stage_accept_{0};
+  size_t stage_build_{0};
+  size_t stage_event_builder_{0};
+  int trace_interval_{0}; // trace one out of every trace_interval work units
 };
 
 } // namespace lager
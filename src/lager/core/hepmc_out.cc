@@ -0,0 +1,169 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "hepmc_out.hh"
+#include <lager/core/assert.hh>
+#include <lager/core/event.hh>
+#include <lager/core/logger.hh>
+
+#include <HepMC3/GenParticle.h>
+#include <HepMC3/GenVertex.h>
+#include <HepMC3/WriterAscii.h>
+#include <HepMC3/WriterAsciiHepMC2.h>
+#ifdef LAGER_HEPMC3_ROOTIO
+#include <HepMC3/WriterRootTree.h>
+#endif
+
+// =============================================================================
+// IMPLEMENTATION: hepmc_out
+// =============================================================================
+namespace lager {
+
+const translation_map<hepmc_out::format>& hepmc_out::format_translator() {
+  static const translation_map<format> tr{
+      {"ascii", format::ASCII},
+      {"ascii_hepmc2", format::ASCII_HEPMC2},
+      {"root_tree", format::ROOT_TREE}};
+  return tr;
+}
+std::string hepmc_out::extension(const format f) {
+  switch (f) {
+  case format::ASCII_HEPMC2:
+    return ".hepmc2";
+  case format::ROOT_TREE:
+    return ".hepmc.root";
+  default:
+    return ".hepmc";
+  }
+}
+
+hepmc_out::hepmc_out(std::unique_ptr<text_writer> os, const format f)
+    : os_{std::move(os)} {
+  tassert(os_, "invalid HepMC output stream");
+  if (f == format::ASCII) {
+    writer_ = std::make_unique<HepMC3::WriterAscii>(os_->stream());
+  } else if (f == format::ASCII_HEPMC2) {
+    writer_ = std::make_unique<HepMC3::WriterAsciiHepMC2>(os_->stream());
+  } else {
+    tassert(false, "The HepMC ROOT tree format needs a file name");
+  }
+}
+hepmc_out::hepmc_out(const std::string& fname) {
+#ifdef LAGER_HEPMC3_ROOTIO
+  writer_ = std::make_unique<HepMC3::WriterRootTree>(fname);
+#else
+  tassert(false, "lAger was compiled without HepMC3 ROOT support (enable "
+                 "the LAGER_HEPMC3_ROOTIO CMake option), cannot write " +
+                     fname);
+#endif
+}
+hepmc_out::~hepmc_out() {
+  // write the footer (and close the ROOT file) before the text output is
+  // destroyed
+  writer_.reset();
+}
+
+void hepmc_out::seek(const int64_t pos) {
+  tassert(os_, "Cannot resume the HepMC ROOT tree output");
+  os_->seek(pos);
+}
+int64_t hepmc_out::checkpoint() {
+  if (!os_) {
+    return 0;
+  }
+  // the HepMC3 ASCII writers pass every event on to the stream, so only the
+  // text output needs to be flushed
+  return os_->checkpoint();
+}
+
+void hepmc_out::write(const event& e, const int event_number) {
+  evt_.clear();
+  evt_.set_event_number(event_number);
+  // HepMC particles corresponding to our particles
+  const size_t n = e.part().size();
+  particles_.clear();
+  for (const auto& part : e.part()) {
+    particles_.push_back(std::make_shared<HepMC3::GenParticle>(
+        HepMC3::FourVector(part.p().X(), part.p().Y(), part.p().Z(),
+                           part.p().E()),
+        part.type<int>(), status(part)));
+  }
+  // a particle is finished once it is added as incoming leg of a vertex
+  finished_.assign(n, 0);
+  // loop over all particles, find and create vertices and build the HepMC event
+  for (size_t i = 0; i < n; ++i) {
+    const auto& part = e.part(i);
+    // 0. Only create vertices from "incoming" lines
+    if (part.n_daughters() == 0) {
+      continue;
+    }
+    // 1. Check if track is already "processed"
+    if (finished_[i]) {
+      continue;
+    }
+    // 2. OK, let's create a new vertex for this particle
+    //    In principle the vertex member of a particle is the start vertex,
+    //    so we get the relevant vertex from the first daughter particle instead
+    const auto& first_daughter = e.part(part.daughter_begin());
+    const auto& raw_vertex = first_daughter.vertex();
+    auto vx = std::make_shared<HepMC3::GenVertex>(HepMC3::FourVector(
+        raw_vertex.X(), raw_vertex.Y(), raw_vertex.Z(), raw_vertex.T()));
+    // 3. Attach incoming lines to this vertex and mark them as "finished"
+    //    Use the first daughter to get the full list of incoming lines
+    for (int iin :
+         {first_daughter.parent_first(), first_daughter.parent_second()}) {
+      if (iin < 0) {
+        continue;
+      }
+      vx->add_particle_in(particles_[iin]);
+      finished_[iin] = 1;
+    }
+    // 4. attach outgoing line to this vertex
+    for (int iout = part.daughter_begin(); iout < part.daughter_end(); ++iout) {
+      vx->add_particle_out(particles_[iout]);
+    }
+    // 5. Add vertex to event
+    evt_.add_vertex(vx);
+  }
+  // Now we are ready to write out the event
+  writer_->write_event(evt_);
+}
+
+int hepmc_out::status(const particle& part) {
+  // undefined: 0
+  // final state: 1
+  // decayed: 2
+  // documentation: 3
+  // incoming: 4
+  if (part.final_state()) {
+    return 1;
+  } else if (part.decayed()) {
+    return 2;
+  } else if (part.documentation()) {
+    return 3;
+  } else if (part.status() == particle::status_code::SECONDARY_BEAM) {
+    // virtual photon: 13, nucleon in nucleus: 2
+    return (part.type() == pdg_id::gamma) ? 13 : 2;
+  } else if (part.status() == particle::status_code::BEAM) {
+    return 4;
+  }
+  return 0;
+}
+
+} // namespace lager
@@ -0,0 +1,98 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_HEPMC_OUT_LOADED
+#define LAGER_CORE_HEPMC_OUT_LOADED
+
+#include <lager/core/configuration.hh>
+#include <lager/core/text_writer.hh>
+
+#include <HepMC3/GenEvent.h>
+#include <HepMC3/Writer.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lager {
+
+class event;
+class particle;
+
+// =============================================================================
+// hepmc_out
+//
+// HepMC3 output for the event records. The HepMC3 event and the particle
+// buffers are reused between events, and the vertices are found with an
+// index-based lookup (linear in the number of particles).
+//
+// Formats:
+//  * ASCII (default): HepMC3 ASCII
+//  * ASCII_HEPMC2: HepMC2 IO_GenEvent ASCII
+//  * ROOT_TREE: HepMC3 ROOT tree in a separate file (only when compiled with
+//    LAGER_HEPMC3_ROOTIO)
+// The ASCII formats are written through a text_writer, so they are buffered
+// and can be compressed on the fly.
+//
+// Checkpoints (ASCII formats only):
+//  * checkpoint() flushes the output and returns the file position
+//  * seek() continues a resumed output at a checkpoint position (dropping the
+//    file header that was written on construction)
+// =============================================================================
+class hepmc_out {
+public:
+  enum class format { ASCII, ASCII_HEPMC2, ROOT_TREE };
+  static const translation_map<format>& format_translator();
+  // file name extension for a format
+  static std::string extension(const format f);
+
+  // ASCII formats
+  hepmc_out(std::unique_ptr<text_writer> os, const format f = format::ASCII);
+  // ROOT tree format
+  explicit hepmc_out(const std::string& fname);
+  ~hepmc_out();
+
+  hepmc_out(const hepmc_out&) = delete;
+  hepmc_out& operator=(const hepmc_out&) = delete;
+
+  // write an event with a given event number
+  void write(const event& e, const int event_number);
+
+  void seek(const int64_t pos);
+  int64_t checkpoint();
+
+private:
+  // HepMC status code for a particle
+  static int status(const particle& part);
+
+  // the text output is declared before the writer, so the writer can write
+  // its footer on destruction
+  std::unique_ptr<text_writer> os_;
+  std::unique_ptr<HepMC3::Writer> writer_;
+
+  // reused event buffers
+  HepMC3::GenEvent evt_{HepMC3::Units::GEV, HepMC3::Units::CM};
+  std::vector<HepMC3::GenParticlePtr> particles_;
+  std::vector<char> finished_; // particles that were added to a vertex
+};
+
+} // namespace lager
+
+#endif
@@ -19,6 +19,8 @@
 
 #include "logger.hh"
 
+#include <chrono>
+
 namespace lager {
 // =============================================================================
 // Implementation: log_handler
@@ -26,17 +28,121 @@ namespace lager {
 log_handler::log_handler(const log_level level, std::ostream& sink)
     : level_{level}, sink_(&sink) {}
 
-void log_handler::set_level(const log_level level) {
+log_handler::~log_handler() {
+  // the writer drains the buffer before it exits
+  stop_.store(true);
+  wake_.notify_one();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+}
+
+void log_handler::set_output(std::ostream& sink) {
+  flush();
   lock_type lock{mutex_};
-  level_ = level;
+  sink_ = &sink;
+}
+
+void log_handler::operator()(const log_level mlevel, const std::string& mtitle,
+                             const std::string& mtext) {
+  if (mlevel > level()) {
+    return;
+  }
+  time_t rt;
+  time(&rt);
+  record rec{mlevel, "[" + std::to_string(rt) + ", " + mtitle + ", " +
+                         LOG_LEVEL_NAMES[static_cast<unsigned>(mlevel)] +
+                         "] " + mtext + "\n"};
+  start();
+  while (!buffer_.try_push(std::move(rec))) {
+    // buffer full: only wait for the writer for important messages
+    if (mlevel > log_level::WARNING) {
+      n_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    wake_.notify_one();
+    std::this_thread::yield();
+  }
+  if (sleeping_.load(std::memory_order_acquire)) {
+    wake_.notify_one();
+  }
+  if (mlevel <= log_level::ERROR) {
+    flush();
+  }
+}
+
+void log_handler::flush() {
+  start();
+  const size_t target = buffer_.n_pushed();
+  std::unique_lock<mutex_type> lock{mutex_};
+  wake_.notify_one();
+  written_.wait(lock, [&] { return n_written_ >= target; });
+}
+
+void log_handler::start() {
+  std::call_once(started_, [this] {
+    writer_ = std::thread{&log_handler::writer_loop, this};
+  });
+}
+
+void log_handler::writer_loop() {
+  std::unique_lock<mutex_type> lock{mutex_};
+  record rec;
+  while (true) {
+    // check before draining, so everything pushed before the stop request is
+    // written
+    const bool stop = stop_.load();
+    size_t n = 0;
+    while (buffer_.try_pop(rec)) {
+      write(rec);
+      n += 1;
+    }
+    const size_t n_dropped = n_dropped_.exchange(0);
+    if (n_dropped > 0) {
+      time_t rt;
+      time(&rt);
+      write({log_level::WARNING,
+             "[" + std::to_string(rt) + ", lager, warning] " +
+                 std::to_string(n_dropped) +
+                 " log messages dropped (log buffer full)\n"});
+    }
+    if (n > 0 || n_dropped > 0) {
+      sink_->flush();
+      std::cout.flush();
+      n_written_ += n;
+      written_.notify_all();
+    }
+    if (stop) {
+      return;
+    }
+    // wait for new messages (with a timeout, as the producers do not lock
+    // before notifying)
+    sleeping_.store(true, std::memory_order_release);
+    wake_.wait_for(lock, std::chrono::milliseconds(10));
+    sleeping_.store(false, std::memory_order_release);
+  }
+}
+
+void log_handler::write(const record& rec) {
+  std::ostream* sink =
+      (rec.level == log_level::ERROR || rec.level == log_level::CRITICAL)
+          ? &std::cerr
+          : sink_;
+  if (sink != &std::cout) {
+    (*sink) << rec.line;
+  }
+  std::cout << rec.line;
+}
+
+void log_handler::set_level(const log_level level) {
+  level_.store(level, std::memory_order_relaxed);
 }
 
 void log_handler::set_level(unsigned ulevel) {
-  lock_type lock{mutex_};
   if (ulevel >= LOG_LEVEL_NAMES.size()) {
     ulevel = LOG_LEVEL_NAMES.size() - 1;
   }
-  level_ = static_cast<log_level>(ulevel);
+  set_level(static_cast<log_level>(ulevel));
 }
 
 // =============================================================================
@@ -21,11 +21,15 @@
 #define LAGER_CORE_LOGGER_LOADED
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <ctime>
 #include <iostream>
+#include <lager/core/ring_buffer.hh>
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <thread>
 
 // =============================================================================
 // default global logger
@@ -40,8 +44,17 @@
 //   * LOG_WARNING(title, text)
 //   * LOG_INFO(title, text)
 //   * LOG_DEBUG(title, text)
-//   * LOG_DEBUG2(title, text)
+//   * LOG_JUNK(title, text)
+//   * LOG_JUNK2(title, text)
+//
+// Messages above LAGER_MAX_LOG_LEVEL (a compile-time definition, all levels by
+// default) are removed from the code entirely. The Release and RelWithDebInfo
+// (default) builds set it to 4 (INFO), which removes the DEBUG and JUNK calls
+// from the event loop.
 // =============================================================================
+#ifndef LAGER_MAX_LOG_LEVEL
+#define LAGER_MAX_LOG_LEVEL 7
+#endif
 namespace lager {
 enum class log_level : unsigned {
   NOTHING = 0,
@@ -56,6 +69,8 @@ enum class log_level : unsigned {
 constexpr std::array<const char*, 8> LOG_LEVEL_NAMES{
     "nothing", "critical", "error", "warning",
     "info",    "debug",    "junk",  "junk2"};
+// highest log level that is compiled in
+constexpr log_level LOG_LEVEL_MAX{static_cast<log_level>(LAGER_MAX_LOG_LEVEL)};
 
 // the global logger
 class log_handler;
@@ -71,41 +86,69 @@ void log(const std::string& mtitle, const std::string& mtext,
 // Strongly prefered over calling the logger function directly, as in the
 // macros,
 // mtitle and mtext (which might be complex expressions) are only evaluated
-// *after* the log_level check.
+// *after* the log_level check, and calls above LOG_LEVEL_MAX are discarded at
+// compile time.
 // This is *significantly* (orders of magnitude!) faster than calling
 // log<LEVEL>(mtitle, mtext) directly in the code.
 #define LOG_CRITICAL(mtitle, mtext)                                            \
-  if (lager::global::logger.level() >= log_level::CRITICAL) {                  \
-    lager::log<lager::log_level::CRITICAL>((mtitle), (mtext));                 \
+  if constexpr (lager::LOG_LEVEL_MAX >= lager::log_level::CRITICAL) {          \
+    if (lager::global::logger.level() >= lager::log_level::CRITICAL) {         \
+      lager::log<lager::log_level::CRITICAL>((mtitle), (mtext));               \
+    }                                                                          \
   }
 #define LOG_ERROR(mtitle, mtext)                                               \
-  if (lager::global::logger.level() >= log_level::ERROR) {                     \
-    lager::log<lager::log_level::ERROR>((mtitle), (mtext));                    \
+  if constexpr (lager::LOG_LEVEL_MAX >= lager::log_level::ERROR) {             \
+    if (lager::global::logger.level() >= lager::log_level::ERROR) {            \
+      lager::log<lager::log_level::ERROR>((mtitle), (mtext));                  \
+    }                                                                          \
   }
 #define LOG_WARNING(mtitle, mtext)                                             \
-  if (lager::global::logger.level() >= log_level::WARNING) {                   \
-    lager::log<lager::log_level::WARNING>((mtitle), (mtext));                  \
+  if constexpr (lager::LOG_LEVEL_MAX >= lager::log_level::WARNING) {           \
+    if (lager::global::logger.level() >= lager::log_level::WARNING) {          \
+      lager::log<lager::log_level::WARNING>((mtitle), (mtext));                \
+    }                                                                          \
   }
 #define LOG_INFO(mtitle, mtext)                                                \
-  if (lager::global::logger.level() >= log_level::INFO) {                      \
-    lager::log<lager::log_level::INFO>((mtitle), (mtext));                     \
+  if constexpr (lager::LOG_LEVEL_MAX >= lager::log_level::INFO) {              \
+    if (lager::global::logger.level() >= lager::log_level::INFO) {             \
+      lager::log<lager::log_level::INFO>((mtitle), (mtext));                   \
+    }                                                                          \
   }
 #define LOG_DEBUG(mtitle, mtext)                                               \
-  if (lager::global::logger.level() >= log_level::DEBUG) {                     \
-    lager::log<lager::log_level::DEBUG>((mtitle), (mtext));                    \
+  if constexpr (lager::LOG_LEVEL_MAX >= lager::log_level::DEBUG) {             \
+    if (lager::global::logger.level() >= lager::log_level::DEBUG) {            \
+      lager::log<lager::log_level::DEBUG>((mtitle), (mtext));                  \
+    }                                                                          \
   }
 #define LOG_JUNK(mtitle, mtext)                                                \
-  if (lager::global::logger.level() >= log_level::JUNK) {                      \
-    lager::log<lager::log_level::JUNK>((mtitle), (mtext));                     \
+  if constexpr (lager::LOG_LEVEL_MAX >= lager::log_level::JUNK) {              \
+    if (lager::global::logger.level() >= lager::log_level::JUNK) {             \
+      lager::log<lager::log_level::JUNK>((mtitle), (mtext));                   \
+    }                                                                          \
   }
 #define LOG_JUNK2(mtitle, mtext)                                               \
-  if (lager::global::logger.level() >= log_level::JUNK2) {                     \
-    lager::log<lager::log_level::JUNK2>((mtitle), (mtext));                    \
+  if constexpr (lager::LOG_LEVEL_MAX >= lager::log_level::JUNK2) {             \
+    if (lager::global::logger.level() >= lager::log_level::JUNK2) {            \
+      lager::log<lager::log_level::JUNK2>((mtitle), (mtext));                  \
+    }                                                                          \
   }
 
 // =============================================================================
 // log_handler class designed for global usage,
 // threading secure
+//
+// The log level is atomic, so the level check in the LOG_* macros does not
+// need to lock the handler.
+//
+// Messages are written asynchronously: the caller formats the message and
+// pushes it to a lock-free ring buffer, and a background thread (started with
+// the first message) writes the messages to the sinks in batches.
+//  * When the buffer is full, WARNING and more severe messages wait for
+//    space, less severe messages are dropped (and the number of dropped
+//    messages is reported).
+//  * ERROR and CRITICAL messages are flushed immediately.
+//  * flush() waits until all messages so far are written. The handler flushes
+//    when the output is changed and on destruction.
 // =============================================================================
 namespace lager {
 class log_handler {
@@ -114,47 +157,48 @@ private:
   typedef std::lock_guard<mutex_type> lock_type;
 
 public:
+  constexpr static const size_t BUFFER_SIZE{8192}; // max number of messages
+
   log_handler(const log_level level = log_level::INFO,
               std::ostream& sink = std::cout);
+  ~log_handler();
 
-  log_level level() const {
-    lock_type lock{mutex_};
-    return level_;
-  }
+  log_level level() const { return level_.load(std::memory_order_relaxed); }
 
   void set_level(const log_level level);
   void set_level(unsigned ulevel);
-  void set_output(std::ostream& sink) { sink_ = &sink; }
+  void set_output(std::ostream& sink);
 
   void operator()(const log_level mlevel, const std::string& mtitle,
-                  const std::string& mtext) {
-    lock_type lock{mutex_};
-    if (mlevel > level_) {
-      return;
-    }
-    time_t rt;
-    time(&rt);
-
-    std::ostream* sink =
-        (mlevel == log_level::ERROR || mlevel == log_level::CRITICAL)
-            ? &std::cerr
-            : sink_;
-
-    if (sink != &std::cout) {
-      (*sink) << "[" << rt << ", " << mtitle << ", "
-              << LOG_LEVEL_NAMES[static_cast<unsigned>(mlevel)] << "] " << mtext
-              << std::endl;
-    }
-
-    std::cout << "[" << rt << ", " << mtitle << ", "
-              << LOG_LEVEL_NAMES[static_cast<unsigned>(mlevel)] << "] " << mtext
-              << std::endl;
-  }
+                  const std::string& mtext);
+
+  // write all pending messages
+  void flush();
 
 private:
-  log_level level_;
-  std::ostream* sink_;
-  mutable mutex_type mutex_;
+  // a formatted message
+  struct record {
+    log_level level{log_level::NOTHING};
+    std::string line;
+  };
+
+  void start();
+  void writer_loop();
+  void write(const record& rec);
+
+  std::atomic<log_level> level_;
+  std::ostream* sink_;   // only used by the writer or while holding mutex_
+  mutable mutex_type mutex_; // protects the sinks and the writer state
+
+  ring_buffer<record> buffer_{BUFFER_SIZE};
+  std::atomic<size_t> n_dropped_{0}; // messages dropped since last report
+  size_t n_written_{0};              // messages written (protected by mutex_)
+  std::once_flag started_;
+  std::thread writer_;
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> sleeping_{false};
+  std::condition_variable wake_;    // wakes up the writer
+  std::condition_variable written_; // signals written messages to flush()
 };
 } // ns lager
 
@@ -23,10 +23,10 @@
 #include <Math/LorentzRotation.h>
 #include <Math/Vector3D.h>
 #include <Math/Vector4D.h>
-#include <TRandom.h>
 #include <lager/core/assert.hh>
 #include <lager/core/interval.hh>
 #include <lager/core/pdg.hh>
+#include <lager/core/random.hh>
 #include <memory>
 
 namespace lager {
@@ -96,9 +96,9 @@ public:
   // status will be auto-set to UNSTABLE for unstable particles, and FINAL for
   // stable particles
   template <class PdgId>
-  particle(const PdgId& id, std::shared_ptr<TRandom> rng);
+  particle(const PdgId& id, random_engine& rng);
   template <class PdgId>
-  particle(const PdgId& id, const XYZVector& p3, std::shared_ptr<TRandom> rng);
+  particle(const PdgId& id, const XYZVector& p3, random_engine& rng);
 
   // particle ID code
   template <class Integer = pdg_id> Integer type() const {
@@ -109,8 +109,8 @@ public:
   int index() const { return index_; }
   void update_index(const int i) { index_ = i; };
 
-  // full PDG info from the TDatabasePDG
-  TParticlePDG* pdg() const { return pdg_; }
+  // PDG info for this particle type
+  const pdg_properties& pdg() const { return *pdg_; }
 
   // particle status
   template <class Integer = status_code> Integer status() const {
@@ -155,9 +155,9 @@ public:
   double mass() const { return mass_; }
   double mass2() const { return mass_ * mass_; }
   // pole mass (differs from mass for unstable particles
-  double pole_mass() const { return pdg_->Mass(); }
+  double pole_mass() const { return pdg_->mass; }
   // width for unstable particles
-  double width() const { return width_; }
+  double width() const { return pdg_->width; }
   // actual generated lifetime for unstable particles
   double lifetime() const { return lifetime_; }
   // parent or parents
@@ -179,7 +179,7 @@ public:
   double theta() const { return p_.theta(); }
   double phi() const { return p_.phi(); }
   // name
-  std::string name() const { return pdg_->GetName(); }
+  const char* name() const { return pdg_->name; }
 
   // get a reference to the momentum/vertex 4-vector
   XYZTVector& p() { return p_; };
@@ -205,17 +205,26 @@ public:
   void set_parents(const interval<int> indices) { parent_ = indices; }
 
 private:
-  void set_mass_lifetime(std::shared_ptr<TRandom> rng);
+  void set_mass_lifetime(random_engine& rng);
   XYZTVector make_4vector(const XYZVector v, const double t) {
     return {v.X(), v.Y(), v.Z(), t};
   }
 
+  // bookkeeping info that is used when walking the event record (status and
+  // parent/daughter indices) is kept together at the start of the particle,
+  // so it shares a cache line with the particle type
   int index_{-1};
   pdg_id type_{pdg_id::unknown};
-  TParticlePDG* pdg_{nullptr};
-  int charge_{0};
-  double width_{0};
   status_code status_{status_code::OTHER};
+  int charge_{0};
+  // parent indices store the first (and optional second) parent of a
+  // particle. -1 if not stored
+  interval<int> parent_{-1, -1};
+  // daughter indices are encoded from [begin, end) where begin is the
+  // first index and end one past the last index. (-1, -1) if none
+  interval<int> daughter_{-1, -1};
+  // entry in the PDG table
+  const pdg_properties* pdg_{nullptr};
 
   // actual mass and lifetime for this particle, can deviate from pole values
   // for unstable particles!
@@ -223,12 +232,6 @@ private:
   double lifetime_{0};
   XYZTVector p_{0, 0, 0, 0};
   XYZTVector vertex_{0, 0, 0, 0};
-  // parent indices store the first (and optional second) parent of a
-  // particle. -1 if not stored
-  interval<int> parent_{-1, -1};
-  // daughter indices are encoded from [begin, end) where begin is the
-  // first index and end one past the last index. (-1, -1) if none
-  interval<int> daughter_{-1, -1};
 };
 // =============================================================================
 // DETECTED PARTICLE
@@ -275,6 +278,14 @@ public:
   // detected vertex
   const XYZTVector& vertex() const { return vertex_; }
 
+  // re-point to the generated particle after the n generated particles
+  // starting at old moved to moved (when the event record is copied or moved)
+  void relink(const particle* old, const particle* moved, const size_t n) {
+    if (generated_ >= old && generated_ < old + n) {
+      generated_ = moved + (generated_ - old);
+    }
+  }
+
   // mass
   double mass() const { return p_.M(); }
   double mass2() const { return p_.M2(); }
@@ -305,22 +316,15 @@ namespace lager {
 // particle with a given id
 inline particle::particle(const pdg_id id, const status_code status)
     : type_{id}
-    , pdg_{pdg_particle(id)}
-    , charge_{static_cast<int>(pdg_->Charge() / 3)}
-    , width_{pdg_->Width()}
     , status_{status}
-    , mass_{pdg_->Mass()}
-    , p_{0, 0, 0, mass_} {}
-// particle with a given name
-inline particle::particle(const std::string& name, const status_code status)
-    : pdg_{pdg_particle(name)}
-    , charge_{static_cast<int>(pdg_->Charge() / 3)}
-    , width_{pdg_->Width()}
-    , status_{status}
-    , mass_{pdg_->Mass()}
+    , pdg_{&pdg_info(id)}
+    , mass_{pdg_->mass}
     , p_{0, 0, 0, mass_} {
-  type_ = static_cast<pdg_id>(pdg_->PdgCode());
+  charge_ = pdg_->charge3 / 3;
 }
+// particle with a given name
+inline particle::particle(const std::string& name, const status_code status)
+    : particle{pdg_info(name).id, status} {}
 inline particle::particle(const int32_t id, const status_code status)
     : particle(static_cast<pdg_id>(id), status) {}
 // particle with a given momentum 3-vector
@@ -348,15 +352,15 @@ particle::particle(const PdgId& id, const XYZTVector& p,
 // RNG constructors usefull in particular for unstable particles with a mass
 // and lifetime that needs to be generated
 template <class PdgId>
-particle::particle(const PdgId& id, std::shared_ptr<TRandom> rng)
+particle::particle(const PdgId& id, random_engine& rng)
     : particle(id) {
-  set_mass_lifetime(std::move(rng));
+  set_mass_lifetime(rng);
 }
 template <class PdgId>
 particle::particle(const PdgId& id, const XYZVector& p3,
-                   std::shared_ptr<TRandom> rng)
+                   random_engine& rng)
     : particle{id} {
-  set_mass_lifetime(std::move(rng));
+  set_mass_lifetime(rng);
   p_.SetXYZT(p3.X(), p3.Y(), p3.Z(), sqrt(mass_ * mass_ + p3.Mag2()));
 }
 //
@@ -378,7 +382,7 @@ inline void particle::add_parent(const int index) {
   } else {
     tassert(false, "A particle can have only have up to 2 parents"
                    "(tried to add additional parent to particle '" +
-                       name() + "')");
+                       std::string(name()) + "')");
   }
 }
 
@@ -429,14 +433,14 @@ inline void particle::boost(const particle::BetaVector& bv) {
 //
 // private utility functions
 //
-inline void particle::set_mass_lifetime(std::shared_ptr<TRandom> rng) {
-  if (pdg_->Stable()) {
-    mass_ = pdg_->Mass();
+inline void particle::set_mass_lifetime(random_engine& rng) {
+  if (pdg_->stable) {
+    mass_ = pdg_->mass;
     lifetime_ = 0;
     status_ = status_code::FINAL;
   } else {
-    mass_ = rng->BreitWigner(pdg_->Mass(), pdg_->Width());
-    lifetime_ = rng->Exp(pdg_->Lifetime());
+    mass_ = rng.BreitWigner(pdg_->mass, pdg_->width);
+    lifetime_ = rng.Exp(pdg_->lifetime());
     status_ = status_code::UNSTABLE;
   }
 }
@@ -18,8 +18,11 @@
 //
 
 #include <TDatabasePDG.h>
+#include <lager/core/exception.hh>
 #include <lager/core/pdg.hh>
+#include <map>
 #include <memory>
+#include <mutex>
 
 namespace lager {
 
@@ -86,8 +89,64 @@ private:
 // global PDG handler
 pdg_handler glb_pdg;
 
+// PDG properties for particles outside of the PDG table, taken from the ROOT
+// database the first time they are requested
+class pdg_extra_handler {
+public:
+  const pdg_properties& find(const pdg_id id) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto it = extra_.find(id);
+    if (it != extra_.end()) {
+      return it->second.info;
+    }
+    TParticlePDG* pdg = glb_pdg.find(id);
+    if (!pdg) {
+      throw lager::exception("Unknown PDG code: " +
+                                 std::to_string(static_cast<int32_t>(id)),
+                             "pdg_error");
+    }
+    // the map nodes are never moved, so the name can point to our copy
+    entry& e = extra_[id];
+    e.name = pdg->GetName();
+    e.info = {id,
+              e.name.c_str(),
+              pdg->Mass(),
+              pdg->Width(),
+              static_cast<int>(pdg->Charge()),
+              static_cast<bool>(pdg->Stable())};
+    return e.info;
+  }
+
+private:
+  struct entry {
+    std::string name;
+    pdg_properties info;
+  };
+  std::mutex mutex_;
+  std::map<pdg_id, entry> extra_;
+};
+
+// global handler for the extra particles
+pdg_extra_handler glb_pdg_extra;
+
 } // unnamed namespace
 
+const pdg_properties& pdg_info_extra(const pdg_id id) {
+  return glb_pdg_extra.find(id);
+}
+const pdg_properties& pdg_info(const std::string& name) {
+  for (const auto& info : PDG_TABLE) {
+    if (name == info.name) {
+      return info;
+    }
+  }
+  TParticlePDG* pdg = glb_pdg.find(name);
+  if (!pdg) {
+    throw lager::exception("Unknown particle name: " + name, "pdg_error");
+  }
+  return pdg_info(static_cast<pdg_id>(pdg->PdgCode()));
+}
+
 TParticlePDG* pdg_particle(const pdg_id id) { return glb_pdg.find(id); }
 TParticlePDG* pdg_particle(const std::string& name) {
   return glb_pdg.find(name);
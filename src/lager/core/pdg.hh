@@ -23,8 +23,11 @@
 #include <TDecayChannel.h>
 #include <TMath.h>
 #include <TParticlePDG.h>
+#include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <memory>
+#include <string>
 
 namespace lager {
 
@@ -164,6 +167,138 @@ enum class pdg_id : int32_t {
   unknown = -9999
 };
 
+// =============================================================================
+// PDG properties for all particles under pdg_id
+//
+// Compile-time version of the PDG info the particle class needs, so particles
+// can be constructed without a database lookup. The table is sorted by PDG
+// code.
+//
+// note: masses and widths in GeV from the PDG review, the nuclei and
+//       pentaquarks follow the entries that are added to the ROOT database in
+//       pdg.cc
+// note: particles are considered stable if they typically reach the detector
+//       (width below 1e-10 GeV)
+// =============================================================================
+struct pdg_properties {
+  pdg_id id;
+  const char* name; // name as used by the ROOT PDG database
+  double mass;
+  double width;
+  int charge3; // charge in units of |e|/3
+  bool stable;
+
+  // mean lifetime in s
+  constexpr double lifetime() const {
+    return (width > 0) ? 6.58211957e-25 / width : 0.;
+  }
+};
+
+inline constexpr pdg_properties PDG_TABLE[] = {
+    {pdg_id::unknown, "Unknown", 0, 0, 0, true},
+    {pdg_id::p_bar, "antiproton", 0.938272, 0, -3, true},
+    {pdg_id::n_bar, "antineutron", 0.939565, 7.478e-28, 0, true},
+    {pdg_id::K_star_minus, "K*-", 0.89166, 0.0508, -3, false},
+    {pdg_id::K_minus, "K-", 0.493677, 5.317e-17, -3, true},
+    {pdg_id::K_star_0_bar, "K*0_bar", 0.89555, 0.0473, 0, false},
+    {pdg_id::K_0_bar, "K0_bar", 0.497611, 0, 0, true},
+    {pdg_id::rho_minus, "rho-", 0.77526, 0.1491, -3, false},
+    {pdg_id::pi_minus, "pi-", 0.13957, 2.5284e-17, -3, true},
+    {pdg_id::W_minus, "W-", 80.379, 2.085, -3, false},
+    {pdg_id::nu_tau_bar, "nu_tau_bar", 0, 0, 0, true},
+    {pdg_id::tau_plus, "tau+", 1.77686, 2.267e-12, 3, true},
+    {pdg_id::nu_mu_bar, "nu_mu_bar", 0, 0, 0, true},
+    {pdg_id::mu_plus, "mu+", 0.105658, 2.9960e-19, 3, true},
+    {pdg_id::nu_e_bar, "nu_e_bar", 0, 0, 0, true},
+    {pdg_id::e_plus, "e+", 0.000510999, 0, 3, true},
+    {pdg_id::t_bar, "t_bar", 172.76, 1.42, -2, false},
+    {pdg_id::b_bar, "b_bar", 4.18, 0, 1, true},
+    {pdg_id::c_bar, "c_bar", 1.27, 0, -2, true},
+    {pdg_id::s_bar, "s_bar", 0.093, 0, 1, true},
+    {pdg_id::u_bar, "u_bar", 0.00216, 0, -2, true},
+    {pdg_id::d_bar, "d_bar", 0.00467, 0, 1, true},
+    {pdg_id::d, "d", 0.00467, 0, -1, true},
+    {pdg_id::u, "u", 0.00216, 0, 2, true},
+    {pdg_id::s, "s", 0.093, 0, -1, true},
+    {pdg_id::c, "c", 1.27, 0, 2, true},
+    {pdg_id::b, "b", 4.18, 0, -1, true},
+    {pdg_id::t, "t", 172.76, 1.42, 2, false},
+    {pdg_id::e_minus, "e-", 0.000510999, 0, -3, true},
+    {pdg_id::nu_e, "nu_e", 0, 0, 0, true},
+    {pdg_id::mu_minus, "mu-", 0.105658, 2.9960e-19, -3, true},
+    {pdg_id::nu_mu, "nu_mu", 0, 0, 0, true},
+    {pdg_id::tau_minus, "tau-", 1.77686, 2.267e-12, -3, true},
+    {pdg_id::nu_tau, "nu_tau", 0, 0, 0, true},
+    {pdg_id::g, "g", 0, 0, 0, true},
+    {pdg_id::gamma, "gamma", 0, 0, 0, true},
+    {pdg_id::Z_0, "Z0", 91.1876, 2.4952, 0, false},
+    {pdg_id::W_plus, "W+", 80.379, 2.085, 3, false},
+    {pdg_id::H_0, "H0", 125.10, 0.0032, 0, false},
+    {pdg_id::reggeon, "reggeon", 0, 0, 0, true},
+    {pdg_id::pomeron, "pomeron", 0, 0, 0, true},
+    {pdg_id::pi_0, "pi0", 0.134977, 7.81e-09, 0, false},
+    {pdg_id::rho_0, "rho0", 0.77526, 0.1491, 0, false},
+    {pdg_id::K_L_0, "K_L0", 0.497611, 1.287e-17, 0, true},
+    {pdg_id::pi_plus, "pi+", 0.13957, 2.5284e-17, 3, true},
+    {pdg_id::rho_plus, "rho+", 0.77526, 0.1491, 3, false},
+    {pdg_id::eta, "eta", 0.547862, 1.31e-06, 0, false},
+    {pdg_id::omega, "omega", 0.78265, 0.00849, 0, false},
+    {pdg_id::K_S_0, "K_S0", 0.497611, 7.351e-15, 0, true},
+    {pdg_id::K_0, "K0", 0.497611, 0, 0, true},
+    {pdg_id::K_star_0, "K*0", 0.89555, 0.0473, 0, false},
+    {pdg_id::K_plus, "K+", 0.493677, 5.317e-17, 3, true},
+    {pdg_id::K_star_plus, "K*+", 0.89166, 0.0508, 3, false},
+    {pdg_id::eta_prime, "eta'", 0.95778, 0.000188, 0, false},
+    {pdg_id::phi, "phi", 1.019461, 0.004249, 0, false},
+    {pdg_id::J_psi, "J/psi", 3.096900, 9.29e-05, 0, false},
+    {pdg_id::upsilon, "Upsilon", 9.46030, 5.402e-05, 0, false},
+    {pdg_id::n, "neutron", 0.939565, 7.478e-28, 0, true},
+    {pdg_id::p, "proton", 0.938272, 0, 3, true},
+    {pdg_id::psi_prime, "psi'", 3.686097, 0.000294, 0, false},
+    // pentaquarks (mass and width not used internally as this changes for
+    // each assumption)
+    {pdg_id::Pc_wang_32p, "Pc_wang_32p", 0, 0, 3, false},
+    {pdg_id::Pc_wang_52p, "Pc_wang_52p", 0, 0, 3, false},
+    {pdg_id::Pc_wang_32m, "Pc_wang_32m", 0, 0, 3, false},
+    {pdg_id::Pc_wang_52m, "Pc_wang_52m", 0, 0, 3, false},
+    {pdg_id::Pc_iso_32p, "Pc_iso_32p", 0, 0, 3, false},
+    {pdg_id::Pc_iso_52p, "Pc_iso_52p", 0, 0, 3, false},
+    {pdg_id::Pc_iso_32m, "Pc_iso_32m", 0, 0, 3, false},
+    {pdg_id::Pc_iso_52m, "Pc_iso_52m", 0, 0, 3, false},
+    // nuclei
+    {pdg_id::H2, "H-2", 1.875613, 0, 3, true},
+    {pdg_id::H3, "H-3", 2.808921, 0, 3, true},
+    {pdg_id::He3, "He-3", 2.808391, 0, 6, true},
+    {pdg_id::He4, "He-4", 3.727379, 0, 6, true},
+    {pdg_id::C12, "C-12", 11.1750, 0, 18, true},
+    {pdg_id::N14, "N-14", 13.0403, 0, 21, true},
+    {pdg_id::Al27, "Al-27", 25.1166, 0, 21, true}};
+
+static_assert(std::is_sorted(std::begin(PDG_TABLE), std::end(PDG_TABLE),
+                             [](const pdg_properties& a,
+                                const pdg_properties& b) {
+                               return a.id < b.id;
+                             }),
+              "PDG_TABLE should be sorted by PDG code");
+
+// compile-time lookup in the PDG table, nullptr if not present
+constexpr const pdg_properties* pdg_find(const pdg_id id) {
+  const auto it = std::lower_bound(
+      std::begin(PDG_TABLE), std::end(PDG_TABLE), id,
+      [](const pdg_properties& a, const pdg_id b) { return a.id < b; });
+  return (it != std::end(PDG_TABLE) && it->id == id) ? it : nullptr;
+}
+
+// PDG properties for a particle ID or name. Particles that are not in the
+// table are looked up in the ROOT PDG database (once).
+// Throws a lager::exception for unknown particles.
+const pdg_properties& pdg_info_extra(const pdg_id id);
+inline const pdg_properties& pdg_info(const pdg_id id) {
+  const pdg_properties* info = pdg_find(id);
+  return info ? *info : pdg_info_extra(id);
+}
+const pdg_properties& pdg_info(const std::string& name);
+
 // Get PID info from the buildin ROOT PDG database
 // note: the custom particles (nuclei, pentaquarks, ...) under pdg_id are added
 // to the database.
@@ -0,0 +1,213 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_RANDOM_LOADED
+#define LAGER_CORE_RANDOM_LOADED
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+namespace lager {
+
+// =============================================================================
+// random_engine
+//
+// Counter-based random number generator (Philox4x32-10, Salmon et al., SC11)
+//
+// The stream is keyed by the run number, and positioned by the event index
+// (the index of the generation work unit). Every (run, index) combination
+// gives an independent, reproducible sequence:
+//    * any work unit can be regenerated on its own by seeking to its index
+//    * threads and nodes get non-overlapping streams without coordination, as
+//      long as they use different work unit indices or run numbers
+//
+// The interface mimics the TRandom member functions used by lAger, but the
+// class is final and has no virtual members, so that calls through a
+// reference can be inlined.
+//
+// Uniform and gaussian random numbers are generated in blocks of BLOCK_SIZE
+// numbers, and handed out from a buffer. The block generation is written
+// lane-by-lane so the compiler can vectorize it (e.g. with
+// COMPILE_FOR_HASWELL).
+// =============================================================================
+class random_engine final {
+public:
+  using counter_type = std::array<uint32_t, 4>;
+  using key_type = std::array<uint32_t, 2>;
+
+  // number of uniform or gaussian random numbers generated in one go
+  constexpr static const size_t BLOCK_SIZE{64};
+
+  // the run number is the first key word, the second key word is always 0
+  explicit random_engine(const uint32_t run = 0) : key_{run, 0} {}
+
+  random_engine(const random_engine&) = delete;
+  random_engine& operator=(const random_engine&) = delete;
+
+  // position the stream at the start of work unit "index"
+  void seek(const uint64_t index);
+  uint64_t index() const { return index_; }
+  uint32_t run() const { return key_[0]; }
+
+  // uniform random number in (0, 1)
+  double Rndm() {
+    if (upos_ == BLOCK_SIZE) {
+      fill_uniform(uniform_.data());
+      upos_ = 0;
+    }
+    return uniform_[upos_++];
+  }
+  // uniform random number in (0, x1) or (x1, x2)
+  double Uniform(const double x1 = 1.) { return x1 * Rndm(); }
+  double Uniform(const double x1, const double x2) {
+    return x1 + (x2 - x1) * Rndm();
+  }
+  // gaussian, exponential and Breit-Wigner distributions
+  double Gaus(const double mean = 0., const double sigma = 1.) {
+    if (gpos_ == BLOCK_SIZE) {
+      fill_gaus(gaus_.data());
+      gpos_ = 0;
+    }
+    return mean + sigma * gaus_[gpos_++];
+  }
+  double Exp(const double tau) { return -tau * std::log(Rndm()); }
+  double BreitWigner(const double mean = 0., const double gamma = 1.) {
+    return mean + 0.5 * gamma * std::tan(std::numbers::pi * (Rndm() - 0.5));
+  }
+
+  // fill a block of BLOCK_SIZE uniform or gaussian random numbers, bypassing
+  // the buffers
+  void fill_uniform(double* block);
+  void fill_gaus(double* block);
+
+  // the Philox4x32-10 bijection for a single counter (e.g. to check the
+  // known-answer vectors), uses the same rounds as fill_uniform()
+  static counter_type philox(const counter_type& ctr, const key_type& key);
+
+private:
+  // Philox4x32-10 rounds for N counters in place, stored lane-by-lane (word w
+  // of counter i in x[w][i]) so the loop over the counters vectorizes
+  template <size_t N>
+  static void philox_rounds(std::array<std::array<uint32_t, N>, 4>& x,
+                            key_type key);
+
+  // convert 2 32-bit words into a double in (0, 1), using 52 random bits
+  // shifted to the center of the bin. The mantissa is filled directly (instead
+  // of an integer to double conversion) so this vectorizes with AVX2
+  static double to_double(const uint32_t hi, const uint32_t lo) {
+    const uint64_t bits = 0x3FF0000000000000ULL |
+                          static_cast<uint64_t>(hi >> 12) << 32 | lo;
+    return (std::bit_cast<double>(bits) - 1.) + 0x1.0p-53;
+  }
+
+  const key_type key_;
+  uint64_t index_{0};   // work unit index
+  uint64_t counter_{0}; // Philox counter within the work unit
+
+  // buffered random numbers
+  std::array<double, BLOCK_SIZE> uniform_;
+  std::array<double, BLOCK_SIZE> gaus_;
+  size_t upos_{BLOCK_SIZE};
+  size_t gpos_{BLOCK_SIZE};
+};
+
+} // namespace lager
+
+// =============================================================================
+// Implementation: random_engine
+//
+// Work horse, all members are defined inline
+// =============================================================================
+namespace lager {
+
+inline void random_engine::seek(const uint64_t index) {
+  index_ = index;
+  counter_ = 0;
+  upos_ = BLOCK_SIZE;
+  gpos_ = BLOCK_SIZE;
+}
+
+inline void random_engine::fill_uniform(double* block) {
+  // Philox4x32-10 on BLOCK_SIZE / 2 consecutive counters, every evaluation
+  // gives 2 doubles
+  constexpr size_t N{BLOCK_SIZE / 2};
+  std::array<std::array<uint32_t, N>, 4> x;
+  for (size_t i = 0; i < N; ++i) {
+    x[0][i] = static_cast<uint32_t>(counter_ + i);
+    x[1][i] = static_cast<uint32_t>((counter_ + i) >> 32);
+    x[2][i] = static_cast<uint32_t>(index_);
+    x[3][i] = static_cast<uint32_t>(index_ >> 32);
+  }
+  philox_rounds(x, key_);
+  for (size_t i = 0; i < N; ++i) {
+    block[2 * i] = to_double(x[0][i], x[1][i]);
+    block[2 * i + 1] = to_double(x[2][i], x[3][i]);
+  }
+  counter_ += N;
+}
+
+inline void random_engine::fill_gaus(double* block) {
+  // Box-Muller on a fresh block of uniforms
+  fill_uniform(block);
+  for (size_t i = 0; i < BLOCK_SIZE; i += 2) {
+    const double r = std::sqrt(-2. * std::log(block[i]));
+    const double phi = 2. * std::numbers::pi * block[i + 1];
+    block[i] = r * std::cos(phi);
+    block[i + 1] = r * std::sin(phi);
+  }
+}
+
+inline random_engine::counter_type
+random_engine::philox(const counter_type& ctr, const key_type& key) {
+  std::array<std::array<uint32_t, 1>, 4> x{
+      {{ctr[0]}, {ctr[1]}, {ctr[2]}, {ctr[3]}}};
+  philox_rounds(x, key);
+  return {x[0][0], x[1][0], x[2][0], x[3][0]};
+}
+
+template <size_t N>
+inline void
+random_engine::philox_rounds(std::array<std::array<uint32_t, N>, 4>& x,
+                             key_type key) {
+  constexpr uint64_t M0{0xD2511F53};
+  constexpr uint64_t M1{0xCD9E8D57};
+  constexpr uint32_t W0{0x9E3779B9};
+  constexpr uint32_t W1{0xBB67AE85};
+  for (int round = 0; round < 10; ++round) {
+    if (round > 0) {
+      key[0] += W0;
+      key[1] += W1;
+    }
+    for (size_t i = 0; i < N; ++i) {
+      const uint64_t p0 = M0 * x[0][i];
+      const uint64_t p1 = M1 * x[2][i];
+      x[0][i] = static_cast<uint32_t>(p1 >> 32) ^ x[1][i] ^ key[0];
+      x[1][i] = static_cast<uint32_t>(p1);
+      x[2][i] = static_cast<uint32_t>(p0 >> 32) ^ x[3][i] ^ key[1];
+      x[3][i] = static_cast<uint32_t>(p0);
+    }
+  }
+}
+
+} // namespace lager
+
+#endif
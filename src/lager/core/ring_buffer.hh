@@ -0,0 +1,121 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_RING_BUFFER_LOADED
+#define LAGER_CORE_RING_BUFFER_LOADED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace lager {
+
+// =============================================================================
+// ring_buffer
+//
+// Bounded lock-free queue for many producers and a single consumer (Vyukov's
+// bounded queue). Every slot carries a sequence number that tells whether it
+// is free for the producer at a given position, or ready for the consumer.
+//
+//  * try_push(value) returns false when the buffer is full
+//  * try_pop(value) returns false when the buffer is empty, and should only be
+//    called from a single consumer thread
+//
+// Note: the capacity is rounded up to a power of 2
+// =============================================================================
+template <class T> class ring_buffer {
+public:
+  explicit ring_buffer(const size_t capacity)
+      : mask_{round_up(capacity) - 1}, slots_{new slot[mask_ + 1]} {
+    for (size_t i = 0; i <= mask_; ++i) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+  ring_buffer(const ring_buffer&) = delete;
+  ring_buffer& operator=(const ring_buffer&) = delete;
+
+  bool try_push(T&& value) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    slot* s = nullptr;
+    while (true) {
+      s = &slots_[pos & mask_];
+      const size_t seq = s->seq.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        // slot is free, try to claim it
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // the consumer did not get to this slot yet: full
+        return false;
+      } else {
+        // another producer claimed this slot
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    s->value = std::move(value);
+    s->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T& value) {
+    slot& s = slots_[tail_ & mask_];
+    if (s.seq.load(std::memory_order_acquire) != tail_ + 1) {
+      return false;
+    }
+    value = std::move(s.value);
+    s.seq.store(tail_ + mask_ + 1, std::memory_order_release);
+    tail_ += 1;
+    return true;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+  // number of values that were pushed so far (including values that were not
+  // popped yet)
+  size_t n_pushed() const { return head_.load(std::memory_order_acquire); }
+
+private:
+  static size_t round_up(const size_t n) {
+    size_t p = 1;
+    while (p < n) {
+      p <<= 1;
+    }
+    return p;
+  }
+
+  struct slot {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  const size_t mask_;
+  std::unique_ptr<slot[]> slots_;
+  // producer and consumer positions on separate cache lines
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) size_t tail_{0};
+};
+
+} // namespace lager
+
+#endif
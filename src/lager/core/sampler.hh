@@ -0,0 +1,246 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_SAMPLER_LOADED
+#define LAGER_CORE_SAMPLER_LOADED
+
+#include <algorithm>
+#include <cmath>
+#include <lager/core/assert.hh>
+#include <lager/core/interval.hh>
+#include <lager/core/random.hh>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lager {
+
+// =============================================================================
+// Samplers for random numbers following an arbitrary (unnormalized) function
+//
+//  * accept_reject: iterative accept-reject for any function with a known
+//    maximum fmax. Works for functions that change between calls, but the
+//    expected number of tries is fmax * width / integral.
+//  * inverse_cdf: tabulated inverse CDF for fixed 1D functions. The function
+//    is approximated as piecewise linear on a regular grid, and a guide table
+//    finds the CDF bin in O(1). Costs a single random number per sample.
+//  * alias_table: Walker alias method for binned p.d.f.s. Returns a bin index
+//    (or a value uniform within that bin) in O(1) for a single random number.
+//
+// Note: negative function values are treated as zero, as they are in the
+//       accept-reject method.
+// =============================================================================
+
+// =============================================================================
+// Iterative accept-reject
+//
+// parameters:
+//  range: generation range
+//  f: arbitrary function (continous within our range)
+//  fmax: maximum of f within our range
+// =============================================================================
+template <class Func1D>
+double accept_reject(random_engine& rng, const interval<double>& range,
+                     Func1D&& f, const double fmax) {
+  while (true) {
+    const double x = rng.Uniform(range.min, range.max);
+    const double test = rng.Uniform(0, fmax);
+    const double fx = f(x);
+    if (test <= fx) {
+      // ensure a proper fmax
+      tassert(fx <= fmax, "fmax set too small in accept_reject call (" +
+                              std::to_string(fx) + ">" +
+                              std::to_string(fmax) + ")");
+      return x;
+    }
+  }
+}
+// same for 2D functions
+template <class Func2D>
+std::pair<double, double>
+accept_reject(random_engine& rng, const interval<double>& range1,
+              const interval<double>& range2, Func2D&& f, const double fmax) {
+  while (true) {
+    const double x = rng.Uniform(range1.min, range1.max);
+    const double y = rng.Uniform(range2.min, range2.max);
+    const double test = rng.Uniform(0, fmax);
+    const double fxy = f(x, y);
+    if (test <= fxy) {
+      // ensure a proper fmax
+      tassert(fxy <= fmax, "fmax set too small in accept_reject call (" +
+                               std::to_string(fxy) + ">" +
+                               std::to_string(fmax) + ")");
+      return {x, y};
+    }
+  }
+}
+
+// =============================================================================
+// Tabulated inverse CDF for a fixed 1D function
+//
+// The function is evaluated once on n_bins + 1 equidistant points, and is
+// linearly interpolated in between. The inverse of the (piecewise quadratic)
+// CDF is exact for this interpolation, so for smooth functions a few hundred
+// bins are plenty.
+// =============================================================================
+class inverse_cdf {
+public:
+  template <class Func1D>
+  inverse_cdf(const interval<double>& range, Func1D&& f,
+              const size_t n_bins = 1000)
+      : range_{range}
+      , n_bins_{n_bins}
+      , step_{range.width() / n_bins}
+      , f_(n_bins + 1)
+      , cdf_(n_bins + 1, 0.)
+      , guide_(n_bins + 1, 0) {
+    tassert(n_bins > 0, "inverse_cdf needs at least one bin");
+    tassert(range.width() > 0, "inverse_cdf needs a non-empty range");
+    for (size_t i = 0; i <= n_bins_; ++i) {
+      f_[i] = std::max(0., static_cast<double>(f(range_.min + i * step_)));
+    }
+    for (size_t i = 0; i < n_bins_; ++i) {
+      cdf_[i + 1] = cdf_[i] + 0.5 * (f_[i] + f_[i + 1]) * step_;
+    }
+    tassert(cdf_[n_bins_] > 0, "inverse_cdf needs a positive integral");
+    // guide table: guide_[j] is the CDF bin that contains j/n_bins of the
+    // total integral
+    size_t i = 0;
+    for (size_t j = 0; j <= n_bins_; ++j) {
+      const double u = cdf_[n_bins_] * j / n_bins_;
+      while (i < n_bins_ - 1 && cdf_[i + 1] < u) {
+        ++i;
+      }
+      guide_[j] = i;
+    }
+  }
+
+  double generate(random_engine& rng) const {
+    const double u = rng.Uniform(0, cdf_[n_bins_]);
+    size_t i = guide_[std::min<size_t>(u / cdf_[n_bins_] * n_bins_, n_bins_)];
+    while (i < n_bins_ - 1 && cdf_[i + 1] < u) {
+      ++i;
+    }
+    // solve f0 * s + k * s^2 / 2 = a for the position s inside the bin, in a
+    // form that is stable for both signs of the slope k
+    const double a = u - cdf_[i];
+    const double f0 = f_[i];
+    const double k = (f_[i + 1] - f_[i]) / step_;
+    const double disc = std::max(0., f0 * f0 + 2. * k * a);
+    const double denom = f0 + std::sqrt(disc);
+    const double s = (denom > 0) ? 2. * a / denom : 0.;
+    return range_.min + (i + std::min(s / step_, 1.)) * step_;
+  }
+  double operator()(random_engine& rng) const { return generate(rng); }
+
+  // integral of the (interpolated) function over the range
+  double integral() const { return cdf_[n_bins_]; }
+
+private:
+  const interval<double> range_;
+  const size_t n_bins_;
+  const double step_;
+  std::vector<double> f_;     // function values at the bin edges
+  std::vector<double> cdf_;   // cumulative integral at the bin edges
+  std::vector<size_t> guide_; // first CDF bin for equidistant CDF values
+};
+
+// =============================================================================
+// Walker alias table for a binned p.d.f.
+//
+// generate(rng) returns a bin index with probability proportional to its
+// weight, generate(rng, range) a value uniform within that bin (for weights
+// on a regular grid over range). Both use a single random number.
+// =============================================================================
+class alias_table {
+public:
+  alias_table(const std::vector<double>& weights)
+      : n_bins_{weights.size()}, prob_(n_bins_, 1.), alias_(n_bins_) {
+    tassert(n_bins_ > 0, "alias_table needs at least one bin");
+    double total = 0;
+    for (const double w : weights) {
+      tassert(w >= 0, "alias_table needs non-negative weights");
+      total += w;
+    }
+    tassert(total > 0, "alias_table needs a positive total weight");
+    // scale the weights so the average bin has probability 1, and split the
+    // bins into under- and overfull ones
+    std::vector<size_t> small;
+    std::vector<size_t> large;
+    for (size_t i = 0; i < n_bins_; ++i) {
+      prob_[i] = weights[i] * n_bins_ / total;
+      alias_[i] = i;
+      (prob_[i] < 1. ? small : large).push_back(i);
+    }
+    // fill each underfull bin with the excess of an overfull one
+    while (!small.empty() && !large.empty()) {
+      const size_t s = small.back();
+      const size_t l = large.back();
+      small.pop_back();
+      alias_[s] = l;
+      prob_[l] -= 1. - prob_[s];
+      if (prob_[l] < 1.) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+    // whatever is left is full up to rounding errors
+    for (const size_t i : small) {
+      prob_[i] = 1.;
+    }
+    for (const size_t i : large) {
+      prob_[i] = 1.;
+    }
+  }
+
+  size_t generate(random_engine& rng) const {
+    double frac = 0;
+    return pick(rng, frac);
+  }
+  double generate(random_engine& rng, const interval<double>& range) const {
+    double frac = 0;
+    const size_t i = pick(rng, frac);
+    return range.min + range.width() * (i + frac) / n_bins_;
+  }
+
+  size_t size() const { return n_bins_; }
+
+private:
+  // choose a bin, and return the leftover fraction of the random number
+  // (uniform in [0, 1)) in frac
+  size_t pick(random_engine& rng, double& frac) const {
+    const double u = rng.Uniform(0, n_bins_);
+    const size_t i = std::min<size_t>(u, n_bins_ - 1);
+    const double r = u - i;
+    if (r < prob_[i]) {
+      frac = r / prob_[i];
+      return i;
+    }
+    frac = (r - prob_[i]) / (1. - prob_[i]);
+    return alias_[i];
+  }
+
+  const size_t n_bins_;
+  std::vector<double> prob_;  // probability to keep bin i
+  std::vector<size_t> alias_;  // bin to use otherwise
+};
+
+} // namespace lager
+
+#endif
@@ -0,0 +1,171 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_SMALL_VECTOR_LOADED
+#define LAGER_CORE_SMALL_VECTOR_LOADED
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace lager {
+
+// =============================================================================
+// small_vector
+//
+// Vector with inline storage for up to N elements. Only when more elements are
+// added, the elements move to the heap (and stay there until the vector is
+// destroyed). Supports the subset of the std::vector interface that is used
+// for the event records.
+//
+// Note: unlike std::vector, moving a small_vector with inline storage moves
+//       the elements themselves, so pointers into the old vector are not
+//       valid for the new vector.
+// =============================================================================
+template <class T, size_t N> class small_vector {
+  static_assert(N > 0, "small_vector needs a non-zero inline capacity");
+
+public:
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  constexpr static const size_t INLINE_CAPACITY{N};
+
+  small_vector() = default;
+  small_vector(const small_vector& rhs) { append(rhs.begin(), rhs.end()); }
+  small_vector(small_vector&& rhs) noexcept { steal(rhs); }
+  small_vector& operator=(const small_vector& rhs) {
+    if (this != &rhs) {
+      clear();
+      append(rhs.begin(), rhs.end());
+    }
+    return *this;
+  }
+  small_vector& operator=(small_vector&& rhs) noexcept {
+    if (this != &rhs) {
+      clear();
+      release();
+      steal(rhs);
+    }
+    return *this;
+  }
+  ~small_vector() {
+    clear();
+    release();
+  }
+
+  // element access
+  T& operator[](const size_t i) { return data_[i]; }
+  const T& operator[](const size_t i) const { return data_[i]; }
+  T& back() { return data_[size_ - 1]; }
+  const T& back() const { return data_[size_ - 1]; }
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+
+  // iterators
+  iterator begin() { return data_; }
+  const_iterator begin() const { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator end() const { return data_ + size_; }
+
+  // size and capacity
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t capacity() const { return capacity_; }
+  bool is_inline() const { return data_ == local(); }
+  void reserve(const size_t n) {
+    if (n > capacity_) {
+      grow(n);
+    }
+  }
+
+  // modifiers
+  void push_back(const T& val) { emplace_back(val); }
+  void push_back(T&& val) { emplace_back(std::move(val)); }
+  template <class... Args> T& emplace_back(Args&&... args) {
+    if (size_ == capacity_) {
+      grow(2 * capacity_);
+    }
+    T* p = new (data_ + size_) T(std::forward<Args>(args)...);
+    ++size_;
+    return *p;
+  }
+  void clear() {
+    std::destroy(begin(), end());
+    size_ = 0;
+  }
+
+private:
+  T* local() { return reinterpret_cast<T*>(buffer_); }
+  const T* local() const { return reinterpret_cast<const T*>(buffer_); }
+
+  void append(const T* first, const T* last) {
+    reserve(size_ + (last - first));
+    std::uninitialized_copy(first, last, end());
+    size_ += last - first;
+  }
+  // move the elements to a heap buffer with capacity n
+  void grow(const size_t n) {
+    T* buf = static_cast<T*>(::operator new(n * sizeof(T)));
+    std::uninitialized_move(begin(), end(), buf);
+    std::destroy(begin(), end());
+    release();
+    data_ = buf;
+    capacity_ = n;
+  }
+  // free the heap buffer (if any), the vector should be empty
+  void release() {
+    if (!is_inline()) {
+      ::operator delete(data_);
+      data_ = local();
+      capacity_ = N;
+    }
+  }
+  // take over the contents of rhs (for an empty vector with inline storage),
+  // a heap buffer is taken over as a whole
+  void steal(small_vector& rhs) {
+    if (rhs.is_inline()) {
+      std::uninitialized_move(rhs.begin(), rhs.end(), local());
+      size_ = rhs.size_;
+      rhs.clear();
+    } else {
+      data_ = rhs.data_;
+      size_ = rhs.size_;
+      capacity_ = rhs.capacity_;
+      rhs.data_ = rhs.local();
+      rhs.size_ = 0;
+      rhs.capacity_ = N;
+    }
+  }
+
+  alignas(T) unsigned char buffer_[N * sizeof(T)];
+  T* data_{local()};
+  size_t size_{0};
+  size_t capacity_{N};
+};
+
+} // namespace lager
+
+#endif
@@ -0,0 +1,202 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "text_writer.hh"
+#include <lager/core/assert.hh>
+#include <lager/core/logger.hh>
+
+#include <zlib.h>
+#ifdef LAGER_ZSTD
+#include <zstd.h>
+#endif
+
+#include <vector>
+
+// =============================================================================
+// text_writer::compressor
+//
+// gzip (zlib) or zstd compression. Every member is a complete gzip stream
+// (zstd frame).
+// =============================================================================
+namespace lager {
+class text_writer::compressor {
+public:
+  constexpr static const size_t OUT_SIZE{1 << 18}; // output chunk [bytes]
+
+  compressor(const compression c, const int level);
+  ~compressor();
+
+  // compress n bytes of data to os, and end the current member when finish is
+  // set
+  void write(const char* data, const size_t n, const bool finish,
+             std::ostream& os);
+
+private:
+  void write_gzip(const char* data, const size_t n, const bool finish,
+                  std::ostream& os);
+  void write_zstd(const char* data, const size_t n, const bool finish,
+                  std::ostream& os);
+
+  const compression type_;
+  std::vector<char> out_ = std::vector<char>(OUT_SIZE);
+  bool open_{false}; // true while a member is open
+  z_stream zs_{};
+#ifdef LAGER_ZSTD
+  ZSTD_CCtx* zstd_{nullptr};
+#endif
+};
+
+text_writer::compressor::compressor(const compression c, const int level)
+    : type_{c} {
+  if (type_ == compression::GZIP) {
+    // window bits 15 + 16 for a gzip header instead of a zlib header
+    const int ret =
+        deflateInit2(&zs_, (level < 0) ? Z_DEFAULT_COMPRESSION : level,
+                     Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    tassert(ret == Z_OK, "Failed to initialize the gzip compression");
+    return;
+  }
+#ifdef LAGER_ZSTD
+  zstd_ = ZSTD_createCCtx();
+  tassert(zstd_, "Failed to initialize the zstd compression");
+  ZSTD_CCtx_setParameter(zstd_, ZSTD_c_compressionLevel,
+                         (level < 0) ? ZSTD_CLEVEL_DEFAULT : level);
+#else
+  tassert(false, "lAger was compiled without zstd support (enable the "
+                 "LAGER_ZSTD CMake option)");
+#endif
+}
+text_writer::compressor::~compressor() {
+  if (type_ == compression::GZIP) {
+    deflateEnd(&zs_);
+  }
+#ifdef LAGER_ZSTD
+  ZSTD_freeCCtx(zstd_);
+#endif
+}
+
+void text_writer::compressor::write(const char* data, const size_t n,
+                                    const bool finish, std::ostream& os) {
+  // no empty members
+  if (n == 0 && (!finish || !open_)) {
+    return;
+  }
+  if (type_ == compression::GZIP) {
+    write_gzip(data, n, finish, os);
+  } else {
+    write_zstd(data, n, finish, os);
+  }
+  open_ = !finish;
+}
+
+void text_writer::compressor::write_gzip(const char* data, const size_t n,
+                                         const bool finish, std::ostream& os) {
+  zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  zs_.avail_in = static_cast<uInt>(n);
+  int ret = Z_OK;
+  do {
+    zs_.next_out = reinterpret_cast<Bytef*>(out_.data());
+    zs_.avail_out = static_cast<uInt>(out_.size());
+    ret = deflate(&zs_, finish ? Z_FINISH : Z_NO_FLUSH);
+    tassert(ret != Z_STREAM_ERROR, "gzip compression failed");
+    os.write(out_.data(), out_.size() - zs_.avail_out);
+  } while (zs_.avail_out == 0);
+  if (finish) {
+    tassert(ret == Z_STREAM_END, "gzip compression failed");
+    // the next member starts with a new gzip header
+    deflateReset(&zs_);
+  }
+}
+
+void text_writer::compressor::write_zstd(const char* data, const size_t n,
+                                         const bool finish, std::ostream& os) {
+#ifdef LAGER_ZSTD
+  ZSTD_inBuffer in{data, n, 0};
+  size_t remaining = 0;
+  do {
+    ZSTD_outBuffer out{out_.data(), out_.size(), 0};
+    remaining = ZSTD_compressStream2(zstd_, &out, &in,
+                                     finish ? ZSTD_e_end : ZSTD_e_continue);
+    tassert(!ZSTD_isError(remaining),
+            "zstd compression failed: " +
+                std::string(ZSTD_getErrorName(remaining)));
+    os.write(out_.data(), out.pos);
+  } while (finish ? (remaining > 0) : (in.pos < in.size));
+#endif
+}
+
+} // namespace lager
+
+// =============================================================================
+// IMPLEMENTATION: text_writer
+// =============================================================================
+namespace lager {
+
+const translation_map<text_writer::compression>&
+text_writer::compression_translator() {
+  static const translation_map<compression> tr{{"none", compression::NONE},
+                                               {"gzip", compression::GZIP},
+                                               {"zstd", compression::ZSTD}};
+  return tr;
+}
+std::string text_writer::extension(const compression c) {
+  switch (c) {
+  case compression::GZIP:
+    return ".gz";
+  case compression::ZSTD:
+    return ".zst";
+  default:
+    return "";
+  }
+}
+
+text_writer::text_writer(std::unique_ptr<std::ofstream> os,
+                         const compression c, const int level)
+    : os_{std::move(os)} {
+  tassert(os_ && *os_, "invalid text output stream");
+  buf_.reserve(BUFFER_SIZE);
+  if (c != compression::NONE) {
+    compressor_ = std::make_unique<compressor>(c, level);
+  }
+}
+text_writer::~text_writer() {
+  try {
+    write_buffer(true);
+    os_->flush();
+  } catch (const std::exception& e) {
+    LOG_ERROR("text_writer", e.what());
+  }
+}
+
+int64_t text_writer::checkpoint() {
+  write_buffer(true);
+  os_->flush();
+  return os_->tellp();
+}
+
+void text_writer::write_buffer(const bool finish) {
+  if (compressor_) {
+    compressor_->write(buf_.data(), buf_.size(), finish, *os_);
+  } else {
+    os_->write(buf_.data(), buf_.size());
+  }
+  buf_.clear();
+}
+
+} // namespace lager
@@ -0,0 +1,149 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_TEXT_WRITER_LOADED
+#define LAGER_CORE_TEXT_WRITER_LOADED
+
+#include <lager/core/configuration.hh>
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+namespace lager {
+
+// =============================================================================
+// text_writer
+//
+// Buffered writer for the text outputs (GEMC/LUND and SIMC). Records are
+// formatted with fmt directly into a large reusable buffer, which is only
+// written to the file once it is full:
+//
+//    writer.print(FMT_STRING("{:5} {:8.6e}\n"), index, value);
+//
+// Writers that need an std::ostream (e.g. the HepMC3 ASCII writers) can use
+// stream(), which appends to the same buffer.
+//
+// The output can optionally be compressed on the fly:
+//  * NONE: plain text, byte-identical to the formatted records
+//  * GZIP: gzip (zlib)
+//  * ZSTD: zstd (only when compiled with LAGER_ZSTD)
+//
+// Checkpoints:
+//  * checkpoint() writes all pending output and returns the file position.
+//    A compressed output ends its gzip member (or zstd frame) at a
+//    checkpoint, so the file up to that position is a complete compressed
+//    file. The next record starts a new member (frame), and the concatenated
+//    members decompress to the full output.
+//  * a resumed output is opened without truncation, and continues at the
+//    checkpoint position with seek(). Anything that was buffered before
+//    (e.g. a file header) is dropped.
+// =============================================================================
+class text_writer {
+public:
+  constexpr static const size_t BUFFER_SIZE{1 << 20}; // buffer size [bytes]
+
+  enum class compression { NONE, GZIP, ZSTD };
+  static const translation_map<compression>& compression_translator();
+  // file name extension for a compression type
+  static std::string extension(const compression c);
+
+  // level -1 uses the default level of the compression algorithm
+  text_writer(std::unique_ptr<std::ofstream> os,
+              const compression c = compression::NONE, const int level = -1);
+  ~text_writer();
+
+  text_writer(const text_writer&) = delete;
+  text_writer& operator=(const text_writer&) = delete;
+
+  // format a record into the buffer
+  template <class... Args>
+  void print(fmt::format_string<Args...> format, Args&&... args) {
+    fmt::format_to(std::back_inserter(buf_), format,
+                   std::forward<Args>(args)...);
+    if (buf_.size() >= BUFFER_SIZE) {
+      write_buffer(false);
+    }
+  }
+
+  // append raw data to the buffer
+  void write(const char* data, const size_t n) {
+    buf_.append(data, data + n);
+    if (buf_.size() >= BUFFER_SIZE) {
+      write_buffer(false);
+    }
+  }
+  // output stream that appends to the buffer
+  std::ostream& stream() { return stream_; }
+
+  // continue writing at a checkpoint position, dropping the buffered output
+  void seek(const int64_t pos) {
+    buf_.clear();
+    os_->seekp(pos);
+  }
+
+  // write all pending output to disk, and return the file position
+  int64_t checkpoint();
+
+private:
+  // compressed output for one gzip member or zstd frame at a time
+  class compressor;
+
+  // stream buffer that forwards to write()
+  class streambuf : public std::streambuf {
+  public:
+    explicit streambuf(text_writer& w) : w_{w} {}
+
+  protected:
+    int_type overflow(const int_type c) override {
+      if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        const char ch = traits_type::to_char_type(c);
+        w_.write(&ch, 1);
+      }
+      return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char* s, const std::streamsize n) override {
+      w_.write(s, n);
+      return n;
+    }
+
+  private:
+    text_writer& w_;
+  };
+
+  // write the buffer, and end the compressed member if finish is set
+  void write_buffer(const bool finish);
+
+  std::unique_ptr<std::ofstream> os_;
+  fmt::memory_buffer buf_;
+  std::unique_ptr<compressor> compressor_; // nullptr without compression
+  streambuf streambuf_{*this};
+  std::ostream stream_{&streambuf_};
+};
+
+} // namespace lager
+
+#endif
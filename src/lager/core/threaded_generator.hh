@@ -0,0 +1,391 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_THREADED_GENERATOR_LOADED
+#define LAGER_CORE_THREADED_GENERATOR_LOADED
+
+#include <lager/core/assert.hh>
+#include <lager/core/generator.hh>
+#include <lager/core/logger.hh>
+#include <lager/core/timer.hh>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lager {
+
+// =============================================================================
+// threaded_generator
+//
+// Runs independent clones of an event_generator in worker threads. Each clone
+// owns its full generator chain (initial state, processes, event processors)
+// and its own RNG, as provided by the factory function.
+//
+// Generation is split in work units, where each call to generate() of a clone
+// is one work unit. The RNG of the clone is positioned at the start of the
+// unit (see random_engine::seek), and the units are merged back in order.
+// The output is therefore identical for any number of threads.
+//
+// The trial and event counters of the workers are merged into the global
+// statistics, which give the global cross section estimate, the number of
+// requested events and the stopping criterion. The estimates themselves are
+// calculated by the first clone (they only depend on settings that are fixed
+// after construction, so this is safe while the clone generates). Events are
+// handed to the caller (which runs the output) batch by batch, and the total
+// number of events handed out never exceeds n_requested().
+//
+// For a single thread, the only clone generates the work units in the calling
+// thread and no worker threads are started.
+//
+// As the RNG state only depends on the work unit index, the generator state
+// after each batch is fully described by the global statistics, the next work
+// unit and the number of events handed out (see checkpoint()). A run that is
+// resumed from this state continues with the same events and statistics as
+// the uninterrupted run. This requires the generator clones to keep no state
+// between work units that is not a function of the configuration (e.g. the
+// accept-reject envelopes are fixed after construction, and PHOTOS draws from
+// the clone RNG). The generation volume is stored along with the state, so a
+// resume with a different volume (e.g. a different configuration) is refused.
+//
+// Usage:
+//    * the factory function is called with indices 0 to N-1, once for every
+//      clone
+//    * worker threads are started on the first call to generate()
+// =============================================================================
+template <class Generator> class threaded_generator {
+public:
+  using generator_type = Generator;
+  using event_type = typename Generator::event_type;
+  using statistics = typename Generator::statistics;
+  using factory_function =
+      std::function<std::unique_ptr<generator_type>(const int)>;
+
+  // generator state between two batches
+  struct state {
+    statistics stats;       // global statistics
+    uint64_t next_unit{0};  // first work unit that was not handed out yet
+    int64_t n_events{0};    // number of events handed out
+    double volume{0};       // generation volume
+  };
+
+  threaded_generator(const int n_threads, const factory_function& make);
+  ~threaded_generator() { stop(); }
+
+  threaded_generator(const threaded_generator&) = delete;
+  threaded_generator& operator=(const threaded_generator&) = delete;
+
+  // get the next batch of events
+  std::vector<event_type> generate();
+
+  // global generation statistics
+  double cross_section() const { return estimator().cross_section(stats_); }
+  double cross_section_error() const {
+    return estimator().cross_section_error(stats_);
+  }
+  double partial_cross_section() const {
+    return estimator().partial_cross_section(stats_);
+  }
+  double partial_cross_section_error() const {
+    return estimator().partial_cross_section_error(stats_);
+  }
+  // per-process breakdown
+  size_t n_processes() const { return stats_.processes.size(); }
+  const std::string& process_name(const size_t i) const {
+    return estimator().process_name(i);
+  }
+  double process_n_trials(const size_t i) const {
+    return stats_.processes[i].n_trials;
+  }
+  double process_n_events(const size_t i) const {
+    return stats_.processes[i].n_events;
+  }
+  double process_n_rejected(const size_t i, const rejection reason) const {
+    return stats_.processes[i].n_rejected[static_cast<size_t>(reason)];
+  }
+  double process_n_max_exceeded(const size_t i) const {
+    return stats_.processes[i].n_max_exceeded;
+  }
+  double n_rejected_initial() const { return stats_.n_rejected_initial; }
+  double process_cross_section(const size_t i) const {
+    return estimator().process_cross_section(stats_, i);
+  }
+  double process_cross_section_error(const size_t i) const {
+    return estimator().process_cross_section_error(stats_, i);
+  }
+  double acceptance() const { return estimator().acceptance(stats_); }
+  int64_t n_requested() const { return estimator().n_requested(stats_); }
+  // number of events handed out to the caller
+  int64_t n_events() const { return n_events_; }
+  bool finished() const {
+    return n_events_ >= n_requested() || precision_reached();
+  }
+  bool precision_reached() const {
+    return estimator().precision_reached(stats_);
+  }
+
+  int n_threads() const { return n_threads_; }
+
+  // time spent in the generation stages, summed over all clones (only
+  // complete once the generation is finished)
+  stage_timing timing() const;
+
+  // state after the last batch returned by generate()
+  state checkpoint() const;
+  // continue from a checkpoint, has to be called before the first generate()
+  void resume(const state& s);
+
+private:
+  // events generated by a worker for a work unit, and the statistics needed
+  // to generate them
+  struct batch {
+    std::vector<event_type> events;
+    statistics delta;
+  };
+
+  // clone used for the estimates from the global statistics
+  const generator_type& estimator() const { return *workers_.front(); }
+
+  void start();
+  void work(generator_type& gen);
+  // generate a work unit with one of the clones
+  batch run(generator_type& gen, const uint64_t unit);
+  batch pop();
+  void stop();
+  // merge a batch into the global statistics, in the same order as the
+  // event_generator would have done it
+  void merge(batch& b);
+
+  const int n_threads_;
+  std::vector<std::unique_ptr<generator_type>> workers_;
+  statistics stats_; // global statistics of the merged work units
+  double volume_{0}; // generation volume (the same for all clones)
+  std::vector<std::thread> threads_;
+
+  // work units that are done, but not yet handed to the caller. Workers only
+  // start on units within a window past the next unit to be merged.
+  const uint64_t window_;
+  std::map<uint64_t, batch> done_;
+  uint64_t next_unit_{0};  // next unit to be generated
+  uint64_t next_merge_{0}; // next unit to be merged
+  std::mutex mutex_;
+  std::condition_variable produced_;
+  std::condition_variable consumed_;
+  std::atomic<bool> stop_{false};
+  std::exception_ptr error_;
+
+  int64_t n_events_{0};
+};
+
+} // namespace lager
+
+// =============================================================================
+// Implementation: threaded_generator
+// =============================================================================
+namespace lager {
+
+template <class Generator>
+threaded_generator<Generator>::threaded_generator(const int n_threads,
+                                                  const factory_function& make)
+    : n_threads_{n_threads}, window_{4 * static_cast<uint64_t>(n_threads)} {
+  tassert(n_threads_ > 0, "Number of threads should be at least 1");
+  if (n_threads_ > 1) {
+    LOG_INFO("threaded_generator",
+             "Initializing " + std::to_string(n_threads_) + " worker threads");
+  }
+  for (int i = 0; i < n_threads_; ++i) {
+    workers_.push_back(make(i));
+    tassert(workers_.back(), "Failed to create event generator for worker " +
+                                 std::to_string(i));
+  }
+  // empty statistics with the right number of processes
+  stats_ = estimator().stats();
+  volume_ = estimator().volume();
+}
+
+template <class Generator>
+typename threaded_generator<Generator>::state
+threaded_generator<Generator>::checkpoint() const {
+  // only the main thread moves next_merge_
+  return {stats_, next_merge_, n_events_, volume_};
+}
+
+template <class Generator>
+void threaded_generator<Generator>::resume(const state& s) {
+  tassert(threads_.empty(), "Cannot resume a generator that already started");
+  tassert(s.volume == volume_,
+          "Cannot resume, the generation volume differs from the checkpoint "
+          "(" + std::to_string(volume_) + " vs. " + std::to_string(s.volume) +
+              ")");
+  tassert(s.stats.processes.size() == stats_.processes.size(),
+          "Process statistics do not match the process list");
+  stats_ = s.stats;
+  next_unit_ = s.next_unit;
+  next_merge_ = s.next_unit;
+  n_events_ = s.n_events;
+  LOG_INFO("threaded_generator",
+           "Resuming at work unit " + std::to_string(next_unit_) + " (" +
+               std::to_string(n_events_) + " events)");
+}
+
+template <class Generator>
+stage_timing threaded_generator<Generator>::timing() const {
+  stage_timing t;
+  for (const auto& worker : workers_) {
+    t.merge(worker->timing());
+  }
+  return t;
+}
+
+template <class Generator> void threaded_generator<Generator>::start() {
+  for (auto& worker : workers_) {
+    threads_.emplace_back([this, &worker] { work(*worker); });
+  }
+}
+
+template <class Generator>
+std::vector<typename threaded_generator<Generator>::event_type>
+threaded_generator<Generator>::generate() {
+  batch b;
+  if (n_threads_ == 1) {
+    b = run(*workers_.front(), next_unit_++);
+    next_merge_ = next_unit_;
+  } else {
+    if (threads_.empty()) {
+      start();
+    }
+    b = pop();
+  }
+  merge(b);
+  auto events = std::move(b.events);
+  // never hand out more events than requested
+  const int64_t n_left = n_requested() - n_events_;
+  if (static_cast<int64_t>(events.size()) > n_left) {
+    events.resize(n_left > 0 ? n_left : 0);
+  }
+  n_events_ += events.size();
+  if (finished()) {
+    stop();
+  }
+  return events;
+}
+
+template <class Generator>
+void threaded_generator<Generator>::work(generator_type& gen) {
+  try {
+    while (true) {
+      // claim the next work unit
+      uint64_t unit;
+      {
+        std::unique_lock<std::mutex> lock{mutex_};
+        consumed_.wait(lock, [this] {
+          return stop_ || next_unit_ < next_merge_ + window_;
+        });
+        if (stop_) {
+          return;
+        }
+        unit = next_unit_++;
+      }
+      auto b = run(gen, unit);
+      // store the result
+      std::lock_guard<std::mutex> lock{mutex_};
+      done_.emplace(unit, std::move(b));
+      produced_.notify_all();
+    }
+  } catch (...) {
+    // hand the error over to the main thread, and stop all other workers
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (!error_) {
+      error_ = std::current_exception();
+    }
+    stop_ = true;
+    produced_.notify_all();
+    consumed_.notify_all();
+  }
+}
+
+template <class Generator>
+typename threaded_generator<Generator>::batch
+threaded_generator<Generator>::run(generator_type& gen, const uint64_t unit) {
+  const statistics before = gen.stats();
+  gen.seek(unit);
+  auto events = gen.generate();
+  return {std::move(events), gen.stats() - before};
+}
+
+template <class Generator>
+typename threaded_generator<Generator>::batch
+threaded_generator<Generator>::pop() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  produced_.wait(lock,
+                 [this] { return error_ || done_.count(next_merge_) > 0; });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+  auto it = done_.find(next_merge_);
+  auto b = std::move(it->second);
+  done_.erase(it);
+  next_merge_ += 1;
+  consumed_.notify_all();
+  return b;
+}
+
+template <class Generator> void threaded_generator<Generator>::merge(batch& b) {
+  // all trials first (along with the per-process counters, which do not
+  // enter in the event record), then the events one by one
+  statistics trials = b.delta;
+  trials.n_events = 0;
+  trials.sum_weights = 0;
+  trials.sum_weights2 = 0;
+  stats_ += trials;
+  for (auto& e : b.events) {
+    statistics one;
+    one.n_events = 1;
+    one.branching_ratio = b.delta.branching_ratio;
+    one.sum_weights = e.weight();
+    one.sum_weights2 = e.weight() * e.weight();
+    stats_ += one;
+    e.update_stat(static_cast<size_t>(stats_.n_events), cross_section());
+  }
+}
+
+template <class Generator> void threaded_generator<Generator>::stop() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stop_ = true;
+    consumed_.notify_all();
+  }
+  for (auto& t : threads_) {
+    if (t.joinable()) {
+      t.join();
+    }
+  }
+}
+
+} // namespace lager
+
+#endif
@@ -0,0 +1,247 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_THREADED_OUTPUT_LOADED
+#define LAGER_CORE_THREADED_OUTPUT_LOADED
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <lager/core/logger.hh>
+#include <lager/core/ring_buffer.hh>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace lager {
+
+// =============================================================================
+// threaded_output
+//
+// Runs an event output (event_out or a derived class) in a dedicated writer
+// thread, so the event generation overlaps with the serialization (tree
+// filling and compression, and the text outputs).
+//
+// Batches of events are handed to the writer through a bounded lock-free
+// queue, and are written in the order they were pushed:
+//  * push() moves a batch into the queue. When the queue is full, push()
+//    waits for the writer (back-pressure).
+//  * flush() waits until all batches so far are written. The output can then
+//    be accessed directly from the calling thread (e.g. for a checkpoint),
+//    until the next push().
+//  * the destructor writes all remaining batches before the output is
+//    destroyed.
+// Errors in the writer thread are re-thrown by the next push() or flush().
+//
+// Without async, no writer thread is started and the batches are written
+// directly by push().
+//
+// Note: push() and flush() should be called from a single thread
+// =============================================================================
+template <class Output, class Event> class threaded_output {
+public:
+  using output_type = Output;
+  using event_type = Event;
+  using position = typename Output::position;
+
+  constexpr static const size_t QUEUE_SIZE{16}; // max number of queued batches
+
+  // the output is constructed in place from args
+  template <class... Args>
+  threaded_output(const bool async, Args&&... args)
+      : output_{std::forward<Args>(args)...}, async_{async} {
+    if (async_) {
+      LOG_INFO("threaded_output", "Writing the output in a separate thread");
+      writer_ = std::thread{&threaded_output::writer_loop, this};
+    }
+  }
+  ~threaded_output() { stop(); }
+
+  threaded_output(const threaded_output&) = delete;
+  threaded_output& operator=(const threaded_output&) = delete;
+
+  // write a batch of events, optionally with the output timing trace enabled
+  void push(std::vector<event_type>&& events, const bool trace = false);
+
+  // wait until all events are written
+  void flush();
+
+  // flush all outputs to disk, and return the current output position
+  position checkpoint() {
+    flush();
+    return output_.checkpoint();
+  }
+
+  // direct access to the output, only safe before the first push() or right
+  // after flush()
+  output_type& output() { return output_; }
+
+private:
+  struct batch {
+    std::vector<event_type> events;
+    bool trace{false};
+  };
+
+  void write(const batch& b) {
+    output_.timing().trace(b.trace);
+    output_.push(b.events);
+  }
+  void writer_loop();
+  void stop();
+  void rethrow_error();
+
+  output_type output_;
+  const bool async_;
+
+  ring_buffer<batch> queue_{QUEUE_SIZE};
+  size_t n_pushed_{0};  // only used by the producer
+  size_t n_written_{0}; // protected by mutex_
+  std::exception_ptr error_; // protected by mutex_
+  std::atomic<bool> failed_{false};
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> sleeping_{false};
+  std::mutex mutex_;
+  std::condition_variable wake_;    // wakes up the writer
+  std::condition_variable written_; // signals written batches to the producer
+  std::thread writer_;
+};
+
+} // namespace lager
+
+// =============================================================================
+// Implementation: threaded_output
+// =============================================================================
+namespace lager {
+
+template <class Output, class Event>
+void threaded_output<Output, Event>::push(std::vector<event_type>&& events,
+                                          const bool trace) {
+  batch b{std::move(events), trace};
+  if (!async_) {
+    write(b);
+    return;
+  }
+  if (failed_.load(std::memory_order_acquire)) {
+    rethrow_error();
+  }
+  // the batch is only moved from when it was actually queued
+  while (!queue_.try_push(std::move(b))) {
+    // queue full, wait for the writer to finish a batch
+    std::unique_lock<std::mutex> lock{mutex_};
+    const size_t n_written = n_written_;
+    wake_.notify_one();
+    written_.wait_for(lock, std::chrono::milliseconds(10),
+                      [&] { return n_written_ > n_written || error_; });
+    if (error_) {
+      lock.unlock();
+      rethrow_error();
+    }
+  }
+  n_pushed_ += 1;
+  if (sleeping_.load(std::memory_order_acquire)) {
+    wake_.notify_one();
+  }
+}
+
+template <class Output, class Event>
+void threaded_output<Output, Event>::flush() {
+  if (!async_) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock{mutex_};
+    wake_.notify_one();
+    written_.wait(lock, [&] { return n_written_ >= n_pushed_; });
+  }
+  rethrow_error();
+}
+
+template <class Output, class Event>
+void threaded_output<Output, Event>::writer_loop() {
+  batch b;
+  while (true) {
+    // check before draining, so everything pushed before the stop request is
+    // written
+    const bool stop = stop_.load();
+    while (queue_.try_pop(b)) {
+      // the output is only touched by this thread while batches are queued,
+      // so the writing itself does not need the lock. After an error, the
+      // remaining batches are dropped.
+      std::exception_ptr error;
+      if (!failed_.load(std::memory_order_relaxed)) {
+        try {
+          write(b);
+        } catch (...) {
+          error = std::current_exception();
+        }
+      }
+      b.events.clear();
+      {
+        std::lock_guard<std::mutex> lock{mutex_};
+        n_written_ += 1;
+        if (error) {
+          error_ = error;
+          failed_.store(true, std::memory_order_release);
+        }
+      }
+      written_.notify_all();
+    }
+    if (stop) {
+      return;
+    }
+    // wait for new batches (with a timeout, as the producer does not lock
+    // before notifying)
+    std::unique_lock<std::mutex> lock{mutex_};
+    sleeping_.store(true, std::memory_order_release);
+    wake_.wait_for(lock, std::chrono::milliseconds(10));
+    sleeping_.store(false, std::memory_order_release);
+  }
+}
+
+template <class Output, class Event>
+void threaded_output<Output, Event>::stop() {
+  if (!writer_.joinable()) {
+    return;
+  }
+  // the writer drains the queue before it exits
+  stop_.store(true);
+  wake_.notify_one();
+  writer_.join();
+  if (error_) {
+    LOG_ERROR("threaded_output", "Output incomplete due to an earlier error");
+  }
+}
+
+template <class Output, class Event>
+void threaded_output<Output, Event>::rethrow_error() {
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    error = error_;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace lager
+
+#endif
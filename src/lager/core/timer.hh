@@ -0,0 +1,288 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef LAGER_CORE_TIMER_LOADED
+#define LAGER_CORE_TIMER_LOADED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <lager/core/logger.hh>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace lager {
+
+// =============================================================================
+// stage_timing
+//
+// Accumulated wall-clock time and number of calls for every stage of the
+// generation pipeline, per process id. Stages are registered once by name,
+// and timed with a scoped_timer:
+//
+//    const size_t decay = timing.stage("decay"); // at initialization
+//    ...
+//    {
+//      scoped_timer t{timing, decay, e.process()};
+//      // do the work
+//    }
+//
+// While tracing is enabled, every timed call is also stored as a span for a
+// Chrome trace-event file (see write_trace(), for chrome://tracing or
+// https://ui.perfetto.dev). The number of spans is bounded by MAX_SPANS.
+//
+// Stages named "parent/child" are nested inside the "parent" stage. They are
+// listed in the report, but not added to the total, so the [%] column only
+// adds up the top-level stages.
+//
+// Note: an instance should only be used by a single thread, instances from
+//       different threads can be merged afterwards.
+// Note: process id -1 is used for stages that do not belong to a process
+// =============================================================================
+class stage_timing {
+public:
+  using clock = std::chrono::steady_clock;
+
+  constexpr static const size_t MAX_SPANS{1000000}; // max number of spans
+
+  struct entry {
+    double seconds{0};
+    uint64_t calls{0};
+  };
+
+  // register a stage (or get the index of an existing stage)
+  size_t stage(const std::string& name) {
+    for (size_t i = 0; i < stages_.size(); ++i) {
+      if (stages_[i] == name) {
+        return i;
+      }
+    }
+    stages_.push_back(name);
+    entries_.emplace_back();
+    return stages_.size() - 1;
+  }
+  size_t n_stages() const { return stages_.size(); }
+  const std::string& stage_name(const size_t stage) const {
+    return stages_[stage];
+  }
+
+  // optional process names (used in the report and trace)
+  void name_process(const int process, const std::string& name) {
+    if (names_.size() <= slot(process)) {
+      names_.resize(slot(process) + 1);
+    }
+    names_[slot(process)] = name;
+  }
+  std::string process_name(const int process) const {
+    if (slot(process) < names_.size() && !names_[slot(process)].empty()) {
+      return names_[slot(process)];
+    }
+    return (process < 0) ? "-" : "process " + std::to_string(process);
+  }
+
+  // add a timed call, or a number of calls timed together
+  void add(const size_t stage, const int process, const clock::time_point start,
+           const clock::time_point stop, const uint64_t calls = 1) {
+    auto& stage_entries = entries_[stage];
+    if (stage_entries.size() <= slot(process)) {
+      stage_entries.resize(slot(process) + 1);
+    }
+    entry& e = stage_entries[slot(process)];
+    e.seconds += std::chrono::duration<double>(stop - start).count();
+    e.calls += calls;
+    if (tracing_ && spans_.size() < MAX_SPANS) {
+      spans_.push_back({stage, process, thread_index(), micros(start),
+                        micros(stop) - micros(start)});
+    }
+  }
+
+  // timing for a stage and process, with an empty entry if never called
+  entry get(const size_t stage, const int process) const {
+    const auto& stage_entries = entries_[stage];
+    return (slot(process) < stage_entries.size())
+               ? stage_entries[slot(process)]
+               : entry{};
+  }
+  // highest process id with timing info
+  int max_process() const {
+    size_t n = 0;
+    for (const auto& stage_entries : entries_) {
+      n = std::max(n, stage_entries.size());
+    }
+    return static_cast<int>(n) - 2;
+  }
+
+  // enable or disable the trace
+  void trace(const bool enable) { tracing_ = enable; }
+  bool tracing() const { return tracing_; }
+  size_t n_spans() const { return spans_.size(); }
+
+  // add the timing (and trace) of another instance
+  void merge(const stage_timing& rhs) {
+    std::vector<size_t> index;
+    for (size_t i = 0; i < rhs.n_stages(); ++i) {
+      index.push_back(stage(rhs.stage_name(i)));
+      for (int p = -1; p <= rhs.max_process(); ++p) {
+        const entry e = rhs.get(i, p);
+        if (e.calls == 0) {
+          continue;
+        }
+        auto& stage_entries = entries_[index[i]];
+        if (stage_entries.size() <= slot(p)) {
+          stage_entries.resize(slot(p) + 1);
+        }
+        stage_entries[slot(p)].seconds += e.seconds;
+        stage_entries[slot(p)].calls += e.calls;
+      }
+    }
+    for (size_t p = 0; p < rhs.names_.size(); ++p) {
+      if (!rhs.names_[p].empty()) {
+        name_process(static_cast<int>(p) - 1, rhs.names_[p]);
+      }
+    }
+    for (span s : rhs.spans_) {
+      if (spans_.size() >= MAX_SPANS) {
+        break;
+      }
+      s.stage = index[s.stage];
+      spans_.push_back(s);
+    }
+  }
+
+  // log a table with the time spent in every stage
+  void report(const std::string& title) const {
+    double total = 0;
+    for (size_t i = 0; i < n_stages(); ++i) {
+      // nested stages are already included in their parent
+      if (stage_name(i).find('/') != std::string::npos) {
+        continue;
+      }
+      for (int p = -1; p <= max_process(); ++p) {
+        total += get(i, p).seconds;
+      }
+    }
+    char line[256];
+    snprintf(line, 256, "%-16s %-16s %12s %12s %12s %8s", "stage", "process",
+             "calls", "total [s]", "mean [us]", "[%]");
+    LOG_INFO(title, line);
+    for (size_t i = 0; i < n_stages(); ++i) {
+      for (int p = -1; p <= max_process(); ++p) {
+        const entry e = get(i, p);
+        if (e.calls == 0) {
+          continue;
+        }
+        snprintf(line, 256, "%-16s %-16s %12llu %12.3f %12.3f %8.2f",
+                 stage_name(i).c_str(), process_name(p).c_str(),
+                 static_cast<unsigned long long>(e.calls), e.seconds,
+                 1e6 * e.seconds / e.calls,
+                 (total > 0) ? 100. * e.seconds / total : 0.);
+        LOG_INFO(title, line);
+      }
+    }
+  }
+
+  // write the spans in the Chrome trace-event format
+  void write_trace(std::ostream& os) const {
+    os << "{\"traceEvents\":[";
+    char buf[512];
+    for (size_t i = 0; i < spans_.size(); ++i) {
+      const span& s = spans_[i];
+      snprintf(buf, 512,
+               "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,"
+               "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+               (i > 0) ? "," : "", stage_name(s.stage).c_str(),
+               process_name(s.process).c_str(), s.thread, s.start,
+               s.duration);
+      os << buf;
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  }
+
+private:
+  // a timed call for the trace (times in microseconds)
+  struct span {
+    size_t stage;
+    int process;
+    int thread;
+    double start;
+    double duration;
+  };
+
+  static size_t slot(const int process) { return process + 1; }
+  // time since program start
+  static double micros(const clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(t - epoch_).count();
+  }
+  inline static const clock::time_point epoch_{clock::now()};
+  // small sequential thread index for the trace
+  static int thread_index() {
+    static std::atomic<int> n_threads{0};
+    thread_local const int index = n_threads++;
+    return index;
+  }
+
+  std::vector<std::string> stages_;
+  std::vector<std::vector<entry>> entries_; // [stage][process + 1]
+  std::vector<std::string> names_;          // [process + 1]
+  bool tracing_{false};
+  std::vector<span> spans_;
+};
+
+// =============================================================================
+// scoped_timer
+//
+// Times its own lifetime as a call to a stage of a stage_timing. The process
+// id can be set after construction, for stages where the process is only known
+// at the end, and the timer can be stopped early with stop().
+// =============================================================================
+class scoped_timer {
+public:
+  scoped_timer(stage_timing& timing, const size_t stage,
+               const int process = -1)
+      : timing_{timing}
+      , stage_{stage}
+      , process_{process}
+      , start_{stage_timing::clock::now()} {}
+  ~scoped_timer() { stop(); }
+  scoped_timer(const scoped_timer&) = delete;
+  scoped_timer& operator=(const scoped_timer&) = delete;
+
+  void set_process(const int process) { process_ = process; }
+  // stop the timer before the end of the scope
+  void stop() {
+    if (running_) {
+      timing_.add(stage_, process_, start_, stage_timing::clock::now());
+      running_ = false;
+    }
+  }
+
+private:
+  stage_timing& timing_;
+  const size_t stage_;
+  int process_;
+  const stage_timing::clock::time_point start_;
+  bool running_{true};
+};
+
+} // namespace lager
+
+#endif
@@ -28,10 +28,9 @@ namespace initial {
 // constant beam
 // =======================================================================================
 constant_beam::constant_beam(const configuration& cf, const string_path& path,
-                             std::shared_ptr<TRandom> r)
+                             std::shared_ptr<random_engine> r)
     : beam_generator{std::move(r)}, beam_{get_beam(cf, path)} {
-  LOG_INFO("initial::constant_beam",
-           "type: " + std::string(beam_.pdg()->GetName()));
+  LOG_INFO("initial::constant_beam", "type: " + std::string(beam_.name()));
   LOG_INFO("initial::constant_beam",
            "energy [GeV]: " + std::to_string(beam_.energy()));
 }
@@ -36,7 +36,7 @@ namespace initial {
 class constant_beam : public beam_generator {
 public:
   constant_beam(const configuration& cf, const string_path& path,
-                std::shared_ptr<TRandom> r);
+                std::shared_ptr<random_engine> r);
   virtual beam generate(const vertex& vx) {
     particle ret = beam_;
     ret.vertex() = vx;
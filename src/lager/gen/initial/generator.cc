@@ -27,10 +27,10 @@ namespace initial {
 // TODO factory auto-registration
 // initialize the factories
 // factory<primary_generator, const configuration&, const string_path&,
-//        std::shared_ptr<TRandom>>
+//        std::shared_ptr<random_engine>>
 //    primary_generator::factory;
 // factory<photon_generator, const configuration&, const string_path&,
-//        std::shared_ptr<TRandom>>
+//        std::shared_ptr<random_engine>>
 //    photon_generator::factory;
 
 // register our generators
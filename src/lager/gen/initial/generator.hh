@@ -41,15 +41,15 @@ public:
   using base_type = lager::generator<Data, Input...>;
 
   static factory<generator, const configuration&, const string_path&,
-                 std::shared_ptr<TRandom>>
+                 std::shared_ptr<random_engine>>
       factory_instance;
 
-  generator(std::shared_ptr<TRandom> r) : base_type{std::move(r)} {}
+  generator(std::shared_ptr<random_engine> r) : base_type{std::move(r)} {}
 };
 
 template <class Data, class... Input>
 factory<generator<Data, Input...>, const configuration&, const string_path&,
-        std::shared_ptr<TRandom>>
+        std::shared_ptr<random_engine>>
     generator<Data, Input...>::factory_instance;
 
 // =============================================================================
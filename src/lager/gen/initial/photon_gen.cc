@@ -73,7 +73,8 @@ inline double bremsstrahlung_intensity_010_param(const double E0,
 // interpolation results above
 inline double bremsstrahlung_intensity_exact(const double rad_len,
                                              const double E0, const double k) {
-  static TF1 integrand(
+  // thread_local as the parameter is updated for every call
+  thread_local TF1 integrand(
       "I_g_gen1_integrand",
       [](double* ttprime, double* uu) {
         const double tprime = ttprime[0];
@@ -107,7 +108,7 @@ namespace initial {
 // no-photon implementation
 // =======================================================================================
 no_photon::no_photon(const configuration& cf, const string_path& path,
-                     std::shared_ptr<TRandom> r)
+                     std::shared_ptr<random_engine> r)
     : photon_generator{std::move(r)} {}
 photon no_photon::generate(const beam&, const target&) { return {1.}; }
 
@@ -115,7 +116,7 @@ photon no_photon::generate(const beam&, const target&) { return {1.}; }
 // bremsstrahlung constructor
 // =======================================================================================
 bremsstrahlung::bremsstrahlung(const configuration& cf, const string_path& path,
-                               std::shared_ptr<TRandom> r)
+                               std::shared_ptr<random_engine> r)
     : photon_generator{std::move(r)}
     , model_{cf.get<bremsstrahlung::model>(path / "model", bs_model_translator)}
     , rl_{(model_ != model::FLAT) ? cf.get<double>(path / "rl") : -1}
@@ -168,7 +169,7 @@ photon bremsstrahlung::generate(const beam& lepton, const target& targ) {
   tassert(lepton.particle().energy() <= E_beam_,
           "Beam energy higher than maximum electron beam energy.");
   // generate a value for E
-  const double E = rng()->Uniform(E_range_.min, E_range_.max);
+  const double E = rng().Uniform(E_range_.min, E_range_.max);
   LOG_JUNK("bremsstrahlung", "Generated E: " + std::to_string(E));
 
   // check if this value is in the allowed range
@@ -213,7 +214,7 @@ double bremsstrahlung::intensity(const double E, const double E_beam) const {
 // =======================================================================================
 bremsstrahlung_realistic_target::bremsstrahlung_realistic_target(
     const configuration& cf, const string_path& path,
-    std::shared_ptr<TRandom> r)
+    std::shared_ptr<random_engine> r)
     : photon_generator{std::move(r)}
     , target_{cf, path}
     , E_beam_{cf.get<double>("beam/lepton/energy")}
@@ -246,7 +247,7 @@ photon bremsstrahlung_realistic_target::generate(const beam& lepton,
   tassert(lepton.particle().energy() <= E_beam_,
           "Beam energy higher than maximum electron beam energy.");
   // generate a value for E
-  const double E = rng()->Uniform(E_range_.min, E_range_.max);
+  const double E = rng().Uniform(E_range_.min, E_range_.max);
   LOG_JUNK("bremsstrahlung_realistic_target",
            "Generated E: " + std::to_string(E));
 
@@ -279,7 +280,7 @@ double bremsstrahlung_realistic_target::intensity(const double E,
 // constructor for vphoton
 // =======================================================================================
 vphoton::vphoton(const configuration& cf, const string_path& path,
-                 std::shared_ptr<TRandom> r)
+                 std::shared_ptr<random_engine> r)
     : photon_generator{std::move(r)}
     , y_range_{cf.get_range<double>(path / "y_range")}
     , logy_range_{std::log(y_range_.min), std::log(y_range_.max)}
@@ -316,8 +317,8 @@ vphoton::vphoton(const configuration& cf, const string_path& path,
 photon vphoton::generate(const beam& lepton, const target& targ) {
 
   // generate a value for Q2 and y
-  const double y = exp(rng()->Uniform(logy_range_.min, logy_range_.max));
-  const double Q2 = exp(rng()->Uniform(logQ2_range_.min, logQ2_range_.max));
+  const double y = exp(rng().Uniform(logy_range_.min, logy_range_.max));
+  const double Q2 = exp(rng().Uniform(logQ2_range_.min, logQ2_range_.max));
 
   LOG_JUNK("vphoton",
            "Generated y: " + std::to_string(y) + " Q2: " + std::to_string(Q2));
@@ -331,7 +332,7 @@ photon vphoton::generate(const beam& lepton, const target& targ) {
   photon pd =
       photon::make_virtual(lepton.particle(), targ.particle(), Q2, y,
                            flux(Q2, y, lepton.particle(), targ.particle()),
-                           rng()->Uniform(0, TMath::TwoPi()));
+                           rng().Uniform(0, TMath::TwoPi()));
 
   LOG_JUNK("vphoton", "nu: " + std::to_string(pd.nu()) +
                           " W2: " + std::to_string(pd.W2()) +
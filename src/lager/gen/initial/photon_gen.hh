@@ -20,7 +20,6 @@
 #ifndef LAGER_GEN_INITIAL_PHOTON_GEN_LOADED
 #define LAGER_GEN_INITIAL_PHOTON_GEN_LOADED
 
-#include <TRandom.h>
 #include <lager/core/generator.hh>
 #include <lager/core/particle.hh>
 #include <lager/gen/initial/data.hh>
@@ -35,7 +34,8 @@ namespace initial {
 // no_photon generator, useful for e.g. DVCS + BH
 class no_photon : public photon_generator {
 public:
-  no_photon(const configuration&, const string_path&, std::shared_ptr<TRandom>);
+  no_photon(const configuration&, const string_path&,
+            std::shared_ptr<random_engine>);
 
   virtual photon generate(const beam&, const target&);
   virtual double max_cross_section() const { return 1.; };
@@ -48,7 +48,7 @@ public:
   enum class model { FLAT, PARAM, APPROX, EXACT };
 
   bremsstrahlung(const configuration& cf, const string_path& path,
-                 std::shared_ptr<TRandom> r);
+                 std::shared_ptr<random_engine> r);
 
   virtual photon generate(const beam&, const target&);
   virtual double max_cross_section() const { return max_; }
@@ -71,7 +71,7 @@ class bremsstrahlung_realistic_target : public photon_generator {
 public:
   bremsstrahlung_realistic_target(const configuration& cf,
                                   const string_path& path,
-                                  std::shared_ptr<TRandom> r);
+                                  std::shared_ptr<random_engine> r);
 
   virtual photon generate(const beam&, const target&);
   virtual double max_cross_section() const { return max_; }
@@ -91,7 +91,7 @@ private:
 class vphoton : public photon_generator {
 public:
   vphoton(const configuration& cf, const string_path& path,
-          std::shared_ptr<TRandom> r);
+          std::shared_ptr<random_engine> r);
 
   virtual photon generate(const beam&, const target&);
   virtual double max_cross_section() const { return max_; }
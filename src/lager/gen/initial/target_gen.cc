@@ -60,7 +60,7 @@ particle estimated_target(const configuration& cf) {
 // target beam constructor
 // =======================================================================================
 primary_target::primary_target(const configuration& cf, const string_path& path,
-                               std::shared_ptr<TRandom> r)
+                               std::shared_ptr<random_engine> r)
     : target_generator{std::move(r)}
     , target_{cf.get<std::string>("beam/ion/particle_type"),
               particle::status_code::SECONDARY_BEAM} {
@@ -74,17 +74,18 @@ target primary_target::generate(const beam& ion) {
 // fermi87 target
 // =======================================================================================
 fermi87::fermi87(const configuration& cf, const string_path& path,
-                 std::shared_ptr<TRandom> r)
+                 std::shared_ptr<random_engine> r)
     : target_generator{std::move(r)}
     , A_{calc_A(cf.get<std::string>("beam/ion/particle_type"))}
     , nucleon_{cf.get<std::string>(path / "nucleon")}
     , k_max_{cf.get<double>(path / "k_max")}
     , norm_{calc_norm()}
-    , xs_max_{calc_max()} {
+    , xs_max_{calc_max()}
+    , P_pdf_{{0., k_max_}, [this](const double P) { return pdf(P); }} {
   LOG_INFO("initial::fermi87",
            "Nucleus: " + cf.get<std::string>("beam/ion/particle_type"));
   LOG_INFO("initial::fermi87", "Calculated A: " + std::to_string(A_));
-  LOG_INFO("initial::fermi87", "Nucleon: " + nucleon_.name());
+  LOG_INFO("initial::fermi87", "Nucleon: " + std::string(nucleon_.name()));
   LOG_INFO("initial::fermi87", "k_max [GeV]: " + std::to_string(k_max_));
   LOG_DEBUG("initial::fermi87",
             "Normalization factor: " + std::to_string(norm_));
@@ -92,10 +93,9 @@ fermi87::fermi87(const configuration& cf, const string_path& path,
 }
 target fermi87::generate(const beam& ion) {
   // Generate a nucleon momentum, theta and phi
-  const double P = rand_f(
-      {0., k_max_}, [&](const double P) { return pdf(P); }, xs_max_ * 1.01);
-  const double theta = acos(rng()->Uniform(-1, 1));
-  const double phi = rng()->Uniform(0., TMath::TwoPi());
+  const double P = rand_f(P_pdf_);
+  const double theta = acos(rng().Uniform(-1, 1));
+  const double phi = rng().Uniform(0., TMath::TwoPi());
   LOG_DEBUG("initial::fermi87",
             "Selected a target nucleon with (P, theta, phi): (" +
                 std::to_string(P) + ", " +
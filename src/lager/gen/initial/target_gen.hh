@@ -20,7 +20,6 @@
 #ifndef LAGER_GEN_INITIAL_TARGET_GEN_LOADED
 #define LAGER_GEN_INITIAL_TARGET_GEN_LOADED
 
-#include <TRandom.h>
 #include <lager/core/generator.hh>
 #include <lager/core/particle.hh>
 #include <lager/gen/initial/data.hh>
@@ -38,7 +37,7 @@ particle estimated_target(const configuration& cf);
 class primary_target : public target_generator {
 public:
   primary_target(const configuration& cf, const string_path& path,
-                 std::shared_ptr<TRandom> r);
+                 std::shared_ptr<random_engine> r);
 
   virtual target generate(const beam& ion);
   // no contribution to the cross section and phase space
@@ -56,7 +55,7 @@ private:
 class fermi87 : public target_generator {
 public:
   fermi87(const configuration& cf, const string_path& path,
-          std::shared_ptr<TRandom> r);
+          std::shared_ptr<random_engine> r);
 
   virtual target generate(const beam& ion);
   // We treat the nucleon selection as orthogonal to the main generation
@@ -82,6 +81,7 @@ private:
   const double k_max_;     // max fermi momentum
   const double norm_;      // internal normalization factor
   const double xs_max_;    // maximum value of the PDF
+  const inverse_cdf P_pdf_; // tabulated PDF for the nucleon momentum
 };
 
 } // namespace initial
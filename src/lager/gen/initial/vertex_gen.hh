@@ -35,7 +35,7 @@ namespace initial {
 class origin_vertex : public vertex_generator {
 public:
   origin_vertex(const configuration& cf, const string_path& path,
-                std::shared_ptr<TRandom> r)
+                std::shared_ptr<random_engine> r)
       : vertex_generator{std::move(r)}
       , vertex_{0, 0, cf.get<double>(path / "vz", 0), 0} {
     LOG_INFO("initial::origin_vertex", "Vertex generator initialized");
@@ -52,7 +52,7 @@ protected:
 class linear_vertex : public vertex_generator {
 public:
   linear_vertex(const configuration& cf, const string_path& path,
-                std::shared_ptr<TRandom> r)
+                std::shared_ptr<random_engine> r)
       : vertex_generator{std::move(r)}
       , range_{cf.get_range<double>(path / "range")} {
     LOG_INFO("initial::linear_vertex", "Vertex generator initialized");
@@ -62,7 +62,7 @@ public:
   }
 
   virtual particle::XYZTVector generate() {
-    const double vz = rng()->Uniform(range_.min, range_.max);
+    const double vz = rng().Uniform(range_.min, range_.max);
     LOG_JUNK2("linear_vertex", "Vertex position [cm]: " + std::to_string(vz));
     return {0., 0., vz, 0};
   }
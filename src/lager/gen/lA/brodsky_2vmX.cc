@@ -32,7 +32,7 @@ namespace lA {
 // Constructor for lA::brodsky_2vmX
 // =============================================================================
 brodsky_2vmX::brodsky_2vmX(const configuration& cf, const string_path& path,
-                           std::shared_ptr<TRandom> r)
+                           std::shared_ptr<random_engine> r)
     : base_type{r}
     , recoil_{cf.get<std::string>(path / "recoil_type")}
     , vm_{cf.get<std::string>(path / "vm_type")}
@@ -59,56 +59,52 @@ brodsky_2vmX::brodsky_2vmX(const configuration& cf, const string_path& path,
   LOG_INFO("brodsky_2vmX",
            "R_vm n-parameter (power): " + std::to_string(R_vm_n_));
   LOG_INFO("brodsky_2vmX", "'Dipole' FF power: " + std::to_string(dipole_n_));
-  LOG_INFO("brodsky_2vmX", "VM: " + std::string(vm_.pdg()->GetName()));
-  LOG_INFO("brodsky_2vmX", "recoil: " + std::string(recoil_.pdg()->GetName()));
+  LOG_INFO("brodsky_2vmX", "VM: " + std::string(vm_.name()));
+  LOG_INFO("brodsky_2vmX", "recoil: " + std::string(recoil_.name()));
 }
 
-lA_event brodsky_2vmX::generate(const lA_data& initial) {
-
-  // generate a mass() in case of non-zero width, initialize the particles
-  particle vm = {vm_.type(), rng()};
-  particle recoil = {recoil_.type(), rng()};
-
-  // shortcuts
-  const auto& gamma = initial.photon();
-  const auto& target = initial.target();
-
-  // check if enough energy available
-  if (gamma.W2() < threshold2(vm, recoil)) {
-    LOG_JUNK("brodsky_2vmX", "Not enough phase space available - W2: " +
-                                 std::to_string(gamma.W2()) + " < " +
-                                 std::to_string(threshold2(vm, recoil)));
-    return lA_event{0.};
-  }
-
-  // generate a phase space point
-  const double t =
-      std::log(rng()->Uniform(max_exp_bt_range_.min, max_exp_bt_range_.max)) /
-      photo_b_;
-
-  LOG_JUNK("brodsky_2vmX", "t: " + std::to_string(t));
+// =============================================================================
+// brodsky_2vmX::evaluate(block, xs)
+// brodsky_2vmX::build(block, lane)
+// =============================================================================
+void brodsky_2vmX::evaluate(const lA_block& block, std::vector<double>& xs) {
+  const size_t n = block.size();
+  trials_.resize(n);
+  xs.resize(n);
 
-  // check if kinematically allowed
-  if (physics::t_range(gamma.W2(), gamma.Q2(), target.particle().mass(),
-                       vm.mass(), recoil.mass())
-          .excludes(t)) {
-    LOG_JUNK("brodsky_2vmX", "t outside of the allowed range for this W2")
-    return lA_event{0.};
+  // generate the VM and recoil particles and the phase space points
+  for (size_t i = 0; i < n; ++i) {
+    trials_.generate(i, vm_, recoil_, rng());
+    trials_.t[i] = std::log(rng().Uniform(max_exp_bt_range_.min,
+                                          max_exp_bt_range_.max)) /
+                   photo_b_;
   }
 
   // evaluate the cross section
-  const double xs_R = R(gamma.Q2());
-  const double xs_dipole = dipole(gamma.Q2());
-  const double xs_photo = dsigma_dexp_bt(gamma.W2(), target.particle().mass());
-  const double xs = (1 + gamma.epsilon() * xs_R) * xs_dipole * xs_photo;
-
-  LOG_JUNK("brodsky_2vmX",
-           "xsec: " + std::to_string(xs_photo) + " < " + std::to_string(max_));
-  LOG_JUNK("brodsky_2vmX", "R: " + std::to_string(xs_R));
-  LOG_JUNK("brodsky_2vmX", "dipole: " + std::to_string(xs_dipole));
-
-  // return a new VM event
-  return make_event(initial, t, vm, recoil, xs, xs_R);
+  for (size_t i = 0; i < n; ++i) {
+    const double W2 = block.W2()[i];
+    const double Q2 = block.Q2()[i];
+    const double Mt = block.Mt()[i];
+    // check if enough energy available, and if t is kinematically allowed
+    const bool allowed =
+        W2 >= trials_.threshold2(i) &&
+        physics::t_range(W2, Q2, Mt, trials_.Mv[i], trials_.Mr[i])
+            .includes(trials_.t[i]);
+    const double xs_R = R(Q2);
+    const double xs_proc =
+        (1 + block.epsilon()[i] * xs_R) * dipole(Q2) * dsigma_dexp_bt(W2, Mt);
+    trials_.R[i] = xs_R;
+    trials_.xs[i] = allowed ? xs_proc : 0.;
+    if (!allowed) {
+      reject(i, (W2 < trials_.threshold2(i)) ? rejection::THRESHOLD
+                                             : rejection::T_RANGE);
+    }
+    xs[i] = block.cross_section(i, trials_.xs[i]);
+  }
+}
+lA_event brodsky_2vmX::build(const lA_block& block, const size_t lane) {
+  return make_event(block[lane], trials_.t[lane], trials_.vm[lane],
+                    trials_.recoil[lane], trials_.xs[lane], trials_.R[lane]);
 }
 
 // =============================================================================
@@ -222,19 +218,6 @@ double brodsky_2vmX::R(const double Q2) const {
 double brodsky_2vmX::dipole(const double Q2) const {
   return physics::dipole_ff_vm(Q2, vm_.mass(), dipole_n_);
 }
-// =============================================================================
-// brodsky_2vmX::threshold2()
-//
-// utility function returns the production threshold squared for the chosen
-// particles. Important to re-calculate in case of a particle with non-zero
-// widht.
-// =============================================================================
-double brodsky_2vmX::threshold2(const particle& vm,
-                                const particle& recoil) const {
-
-  return recoil.mass2() + vm.mass2() + 2 * vm.mass() * recoil.mass();
-}
-
 // =============================================================================
 // create the lA_event dataf, calculates the final state four-vectors in
 // the lab-frame
@@ -276,7 +259,7 @@ lA_event brodsky_2vmX::make_event(const lA_data& initial, const double t,
   const double ctheta_cm =
       (t + 2 * Et_cm * Er_cm - Mt2 - Mr2) / (2 * Pt_cm * Pr_cm);
   const double theta_cm = std::acos(ctheta_cm);
-  const double phi_cm = rng()->Uniform(0, TMath::TwoPi());
+  const double phi_cm = rng().Uniform(0, TMath::TwoPi());
 
   // create the CM 4-vectors
   const particle::Polar3DVector p3_v{Pv_cm, theta_cm, phi_cm};
@@ -46,8 +46,9 @@ public:
   using base_type = lA::generator;
 
   brodsky_2vmX(const configuration& cf, const string_path& path,
-               std::shared_ptr<TRandom> r);
-  virtual lA_event generate(const lA_data&);
+               std::shared_ptr<random_engine> r);
+  virtual void evaluate(const lA_block& block, std::vector<double>& xs);
+  virtual lA_event build(const lA_block& block, const size_t lane);
   virtual double max_cross_section() const { return max_; }
   virtual double phase_space() const { return max_exp_bt_range_.width(); }
 
@@ -67,10 +68,6 @@ private:
   // jacobian for d/dexp_bt -> d/dt
   double jacobian(const double t) const;
 
-  // threshold squared for these particular particles (correctly handels the
-  // case of particles with non-zero width)
-  double threshold2(const particle& vm, const particle& recoil) const;
-
   // utility function
   lA_event make_event(const lA_data& initial, const double t, particle vm1,
                       particle X1, const double xs, const double R);
@@ -91,6 +88,9 @@ private:
   const interval<double> max_t_range_;
   const interval<double> max_exp_bt_range_;
   const double max_;
+
+  // scratch space for the batched interface
+  vm_trials trials_;
 };
 
 } // namespace lA
@@ -18,16 +18,19 @@
 // 
 
 #include "generator.hh"
-#include <TRandom.h>
+#include <cmath>
 #include <memory>
 
 #include <lager/core/configuration.hh>
+#include <lager/core/logger.hh>
+#include <lager/gen/initial/target_gen.hh>
+#include <lager/physics/kinematics.hh>
 
 namespace lager {
 
 // initialize the factory
 //factory<lA::generator, const configuration&, const string_path&,
-//        std::shared_ptr<TRandom>>
+//        std::shared_ptr<random_engine>>
 //    lA::generator::factory;
 namespace lA {
 
@@ -35,5 +38,94 @@ namespace lA {
 //FACTORY_REGISTER(generator, brodsky_2vmX, "brodsky_2vmX");
 //FACTORY_REGISTER(generator, gaussian_qpq, "gaussian_1qpq");
 
+void vm_trials::generate(const lA_block& block, const particle& vm_type,
+                         const particle& recoil_type,
+                         const interval<double>& t_range, const envelope* env,
+                         random_engine& rng) {
+  const size_t n = block.size();
+  resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    generate(i, vm_type, recoil_type, rng);
+    jacobian[i] = 1.;
+    if (env) {
+      const size_t cell = env->cell(block.W()[i], block.Q2()[i]);
+      t[i] = env->generate(cell, rng, jacobian[i]);
+    } else {
+      t[i] = rng.Uniform(t_range.min, t_range.max);
+    }
+  }
+}
+
+std::unique_ptr<envelope> make_vm_envelope(const configuration& cf,
+                                           const string_path& path,
+                                           const particle& vm,
+                                           const particle& recoil,
+                                           const interval<double>& t_range,
+                                           const vm_cross_section& xs) {
+  if (!cf.get<bool>(path / "envelope/enable", false)) {
+    return nullptr;
+  }
+  const size_t n_W = cf.get<int>(path / "envelope/W_bins", 20);
+  const size_t n_Q2 = cf.get<int>(path / "envelope/Q2_bins", 10);
+  const size_t n_t = cf.get<int>(path / "envelope/t_bins", 50);
+  const double safety = cf.get<double>(path / "envelope/safety", 1.2);
+  const double floor = cf.get<double>(path / "envelope/floor", 0.01);
+
+  // get the extreme beam parameters (where the photon carries all of the
+  // lepton beam energy
+  const particle photon{pdg_id::gamma,
+                        cf.get_vector3<particle::XYZVector>("beam/lepton/dir"),
+                        cf.get<double>("beam/lepton/energy")};
+  const particle target{initial::estimated_target(cf)};
+
+  // W-range from the production threshold (in case of particles with non-zero
+  // width, we use M - 4 x sigma) up to the maximum W, or the user-defined
+  // W-range
+  const double Wth = vm.pole_mass() - vm.width() * 4. + recoil.pole_mass() -
+                     recoil.width() * 4.;
+  const double Wmax = (photon.p() + target.p()).M();
+  const auto opt_W_range = cf.get_optional_range<double>("photon/W_range");
+  const interval<double> W_range =
+      opt_W_range ? interval<double>{fmax(Wth, opt_W_range->min),
+                                     fmin(Wmax, opt_W_range->max)}
+                  : interval<double>{Wth, Wmax};
+
+  // Q2-range from the photon settings, or all of the Q2-range up to the
+  // maximum Q2 at threshold
+  const double Q2max = target.mass2() + 2 * photon.p().Dot(target.p()) -
+                       W_range.min * W_range.min;
+  const auto opt_Q2_range = cf.get_optional_range<double>("photon/Q2_range");
+  const interval<double> Q2_range =
+      opt_Q2_range ? *opt_Q2_range : interval<double>{0., fmax(Q2max, 0.)};
+
+  LOG_INFO("envelope", "W range [GeV]: [" + std::to_string(W_range.min) +
+                           ", " + std::to_string(W_range.max) + "], " +
+                           std::to_string(n_W) + " bins");
+  LOG_INFO("envelope", "Q2 range [GeV^2]: [" + std::to_string(Q2_range.min) +
+                           ", " + std::to_string(Q2_range.max) + "], " +
+                           std::to_string(n_Q2) + " bins");
+  LOG_INFO("envelope", "t range [GeV^2]: [" + std::to_string(t_range.min) +
+                           ", " + std::to_string(t_range.max) + "], " +
+                           std::to_string(n_t) + " bins");
+  LOG_INFO("envelope", "safety factor: " + std::to_string(safety) +
+                           ", floor: " + std::to_string(floor));
+
+  auto env = std::make_unique<envelope>(W_range, n_W, Q2_range, n_Q2, t_range,
+                                        n_t, safety, floor);
+  const double Mt = target.mass();
+  const double Mv = vm.mass();
+  const double Mr = recoil.mass();
+  env->explore(
+      [&](const double W, const double Q2, const double t) {
+        return xs(W, Q2, t, Mt);
+      },
+      [=](const double W, const double Q2) {
+        return (W > Mv + Mr) ? physics::t_range(W * W, Q2, Mt, Mv, Mr)
+                             : interval<double>{0., -1.};
+      });
+  LOG_INFO("envelope", "envelope maximum: " + std::to_string(env->max()));
+  return env;
+}
+
 } // namespace lA
 } // namespace lager
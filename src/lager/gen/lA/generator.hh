@@ -20,9 +20,16 @@
 #ifndef LAGER_GEN_LA_GENERATOR_LOADED
 #define LAGER_GEN_LA_GENERATOR_LOADED
 
+#include <lager/core/configuration.hh>
+#include <lager/core/envelope.hh>
 #include <lager/core/generator.hh>
+#include <lager/core/particle.hh>
 #include <lager/gen/lA_event.hh>
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 // =============================================================================
 // main include file for lA generators
 // =============================================================================
@@ -33,7 +40,79 @@ namespace lA {
 // =============================================================================
 // lA generator type
 // =============================================================================
-using generator = lager::process_generator<lA_event, lA_data>;
+using generator = lager::process_generator<lA_event, lA_data, lA_block>;
+
+// =============================================================================
+// lA::vm_trials
+//
+// Per-lane scratch space for the batched evaluation of gamma + A -> VM + X
+// processes. Stores the VM and recoil particles (with their generated mass in
+// case of non-zero width) and the phase space point and cross section
+// components needed to build the event for an accepted lane.
+// =============================================================================
+struct vm_trials {
+  std::vector<particle> vm;
+  std::vector<particle> recoil;
+  std::vector<double> Mv;
+  std::vector<double> Mr;
+  std::vector<double> t;
+  std::vector<double> xs;
+  std::vector<double> R;
+  std::vector<double> jacobian;
+
+  void resize(const size_t n) {
+    vm.resize(n);
+    recoil.resize(n);
+    Mv.resize(n);
+    Mr.resize(n);
+    t.resize(n);
+    xs.resize(n);
+    R.resize(n);
+    jacobian.resize(n);
+  }
+  // generate the VM and recoil particle for lane i
+  void generate(const size_t i, const particle& vm_type,
+                const particle& recoil_type, random_engine& rng) {
+    vm[i] = {vm_type.type(), rng};
+    recoil[i] = {recoil_type.type(), rng};
+    Mv[i] = vm[i].mass();
+    Mr[i] = recoil[i].mass();
+  }
+  // generate the VM and recoil particles and t for all lanes of the block,
+  // with t sampled from the envelope of the (W, Q2) cell when an envelope is
+  // given, and uniformly over t_range otherwise
+  void generate(const lA_block& block, const particle& vm_type,
+                const particle& recoil_type, const interval<double>& t_range,
+                const envelope* env, random_engine& rng);
+  // production threshold squared for lane i
+  double threshold2(const size_t i) const {
+    return Mr[i] * Mr[i] + Mv[i] * Mv[i] + 2 * Mv[i] * Mr[i];
+  }
+};
+
+// =============================================================================
+// lA::make_vm_envelope
+//
+// Construct and explore the accept-reject envelope for a gamma + A -> VM + X
+// process with the given t-range and cross section xs(W, Q2, t, Mt) (with
+// epsilon = 1 as upper bound on the (1 + epsilon * R) factor), from the
+// optional configuration block at path/envelope:
+//    * enable: use the envelope (default: false, returns a nullptr)
+//    * W_bins, Q2_bins, t_bins: number of bins (default: 20, 10, 50)
+//    * safety: safety factor for the explored maxima (default: 1.2)
+//    * floor: minimum bound, relative to the maximum in the (W, Q2) cell
+//      (default: 0.01)
+// The W and Q2 ranges are derived from the beam and photon settings, the
+// target mass from the estimated target.
+// =============================================================================
+using vm_cross_section = std::function<double(
+    const double W, const double Q2, const double t, const double Mt)>;
+std::unique_ptr<envelope> make_vm_envelope(const configuration& cf,
+                                           const string_path& path,
+                                           const particle& vm,
+                                           const particle& recoil,
+                                           const interval<double>& t_range,
+                                           const vm_cross_section& xs);
 
 } // namespace beam
 } // namespace lager
@@ -32,7 +32,7 @@ namespace lA {
 // Constructor for lA::holographic_vm
 // =============================================================================
 holographic_vm::holographic_vm(const configuration& cf, const string_path& path,
-                               std::shared_ptr<TRandom> r)
+                               std::shared_ptr<random_engine> r)
     : base_type{r}
     , recoil_{cf.get<std::string>(path / "recoil_type")}
     , vm_{cf.get<std::string>(path / "vm_type")}
@@ -57,63 +57,72 @@ holographic_vm::holographic_vm(const configuration& cf, const string_path& path,
   LOG_INFO("brodsky_2vmX",
            "R_vm n-parameter (power): " + std::to_string(R_vm_n_));
   LOG_INFO("brodsky_2vmX", "'Dipole' FF power: " + std::to_string(dipole_n_));
-  LOG_INFO("holographic_vm", "VM: " + std::string(vm_.pdg()->GetName()));
+  LOG_INFO("holographic_vm", "VM: " + std::string(vm_.name()));
   LOG_INFO("holographic_vm",
-           "recoil: " + std::string(recoil_.pdg()->GetName()));
-}
-
-lA_event holographic_vm::generate(const lA_data& initial) {
-
-  // generate a mass() in case of non-zero width, initialize the particles
-  particle vm = {vm_.type(), rng()};
-  particle recoil = {recoil_.type(), rng()};
-
-  // shortcuts
-  const auto& gamma = initial.photon();
-  const auto& target = initial.target();
-
-  // check if enough energy available
-  if (gamma.W2() < threshold2(vm, recoil)) {
-    LOG_JUNK("holographic_vm", "Not enough phase space available - W2: " +
-                                   std::to_string(gamma.W2()) + " < " +
-                                   std::to_string(threshold2(vm, recoil)));
-    return lA_event{0.};
+           "recoil: " + std::string(recoil_.name()));
+  // accept-reject envelope (if enabled), the envelope maximum replaces the
+  // cross section maximum
+  envelope_ = make_vm_envelope(
+      cf, path, vm_, recoil_, max_t_range_,
+      [this](const double W, const double Q2, const double t,
+             const double Mt) {
+        const double Mv = vm_.mass();
+        return (1 + physics::R_vm_martynov(Q2, Mv, R_vm_c_, R_vm_n_)) *
+               physics::dsigma_dt_holographic(Q2, W, t, Mt, Mv, A0_, m_A_, C0_,
+                                              m_C_, N_) *
+               physics::dipole_ff_vm(Q2, Mv, dipole_n_);
+      });
+  if (envelope_) {
+    max_ = envelope_->max();
   }
+}
 
-  // generate a phase space point
-  const double t = rng()->Uniform(max_t_range_.min, max_t_range_.max);
-
-  LOG_JUNK("holographic_vm", "t: " + std::to_string(t));
+// =============================================================================
+// holographic_vm::evaluate(block, xs)
+// holographic_vm::build(block, lane)
+// =============================================================================
+void holographic_vm::evaluate(const lA_block& block, std::vector<double>& xs) {
+  const size_t n = block.size();
+  xs.resize(n);
 
-  // check if kinematically allowed
-  if (physics::t_range(gamma.W2(), gamma.Q2(), target.particle().mass(),
-                       vm.mass(), recoil.mass())
-          .excludes(t)) {
-    LOG_JUNK("holographic_vm", "t outside of the allowed range for this W2")
-    return lA_event{0.};
-  }
+  // generate the VM and recoil particles and the phase space points
+  trials_.generate(block, vm_, recoil_, max_t_range_, envelope_.get(), rng());
 
   // evaluate the cross section
-  const double dipole_Q2 =
-      physics::dipole_ff_vm(gamma.Q2(), vm_.mass(), dipole_n_);
-  const double sigma_gamma = physics::dsigma_dt_holographic(
-      gamma.Q2(), gamma.W(), t, target.particle().mass(), vm_.mass(), A0_, m_A_,
-      C0_, m_C_, N_);
-
-  const double sigmaT = sigma_gamma * dipole_Q2;
-  const double R =
-      physics::R_vm_martynov(gamma.Q2(), vm_.mass(), R_vm_c_, R_vm_n_);
-
-  const double xs = (1 + gamma.epsilon() * R) * sigmaT;
-
-  LOG_JUNK("holographic_vm",
-           "xsec: " + std::to_string(xs) + " < " + std::to_string(max_));
-  LOG_JUNK("holographic_vm", "sigma_gamma: " + std::to_string(sigma_gamma));
-  LOG_JUNK("holographic_vm", "sigmaT: " + std::to_string(sigmaT));
-  LOG_JUNK("holographic_vm", "R: " + std::to_string(R));
-
-  // return a new VM event
-  return make_event(initial, t, vm, recoil, xs, R);
+  const double Mv = vm_.mass();
+  for (size_t i = 0; i < n; ++i) {
+    const double W = block.W()[i];
+    const double W2 = block.W2()[i];
+    const double Q2 = block.Q2()[i];
+    const double Mt = block.Mt()[i];
+    const double t = trials_.t[i];
+    // check if enough energy available, and if t is kinematically allowed
+    const bool allowed =
+        W2 >= trials_.threshold2(i) &&
+        physics::t_range(W2, Q2, Mt, trials_.Mv[i], trials_.Mr[i])
+            .includes(t);
+    const double dipole_Q2 = physics::dipole_ff_vm(Q2, Mv, dipole_n_);
+    const double sigma_gamma = physics::dsigma_dt_holographic(
+        Q2, W, t, Mt, Mv, A0_, m_A_, C0_, m_C_, N_);
+    const double sigmaT = sigma_gamma * dipole_Q2;
+    const double R = physics::R_vm_martynov(Q2, Mv, R_vm_c_, R_vm_n_);
+    const double xs_proc = (1 + block.epsilon()[i] * R) * sigmaT;
+    trials_.R[i] = R;
+    trials_.xs[i] = allowed ? xs_proc * trials_.jacobian[i] : 0.;
+    if (!allowed) {
+      reject(i, (W2 < trials_.threshold2(i)) ? rejection::THRESHOLD
+                                             : rejection::T_RANGE);
+    }
+    xs[i] = block.cross_section(i, trials_.xs[i]);
+  }
+}
+lA_event holographic_vm::build(const lA_block& block, const size_t lane) {
+  lA_event e = make_event(block[lane], trials_.t[lane], trials_.vm[lane],
+                          trials_.recoil[lane], trials_.xs[lane],
+                          trials_.R[lane]);
+  // undo the envelope jacobian for the output cross section
+  e.update_jacobian(1. / trials_.jacobian[lane]);
+  return e;
 }
 
 // =============================================================================
@@ -199,19 +208,6 @@ holographic_vm::calc_max_t_range(const configuration& cf,
                   : interval<double>{tlim1.min, tlim2.max};
   return tlim;
 }
-// =============================================================================
-// holographic_vm::threshold2()
-//
-// utility function returns the production threshold squared for the chosen
-// particles. Important to re-calculate in case of a particle with non-zero
-// widht.
-// =============================================================================
-double holographic_vm::threshold2(const particle& vm,
-                                  const particle& recoil) const {
-
-  return recoil.mass2() + vm.mass2() + 2 * vm.mass() * recoil.mass();
-}
-
 // =============================================================================
 // create the lA_event dataf, calculates the final state four-vectors in
 // the lab-frame
@@ -251,7 +247,7 @@ lA_event holographic_vm::make_event(const lA_data& initial, const double t,
   const double ctheta_cm =
       (t + 2 * Et_cm * Er_cm - Mt2 - Mr2) / (2 * Pt_cm * Pr_cm);
   const double theta_cm = std::acos(ctheta_cm);
-  const double phi_cm = rng()->Uniform(0, TMath::TwoPi());
+  const double phi_cm = rng().Uniform(0, TMath::TwoPi());
 
   // create the CM 4-vectors
   const particle::Polar3DVector p3_v{Pv_cm, theta_cm, phi_cm};
@@ -46,8 +46,9 @@ public:
   using base_type = lA::generator;
 
   holographic_vm(const configuration& cf, const string_path& path,
-                 std::shared_ptr<TRandom> r);
-  virtual lA_event generate(const lA_data&);
+                 std::shared_ptr<random_engine> r);
+  virtual void evaluate(const lA_block& block, std::vector<double>& xs);
+  virtual lA_event build(const lA_block& block, const size_t lane);
   virtual double max_cross_section() const { return max_; }
   virtual double phase_space() const { return max_t_range_.width(); }
 
@@ -56,11 +57,6 @@ private:
   interval<double> calc_max_t_range(const configuration& cf,
                                     const string_path& path) const;
 
-  // FIXME this should be a general utility function
-  // threshold squared for these particular particles (correctly handels the
-  // case of particles with non-zero width)
-  double threshold2(const particle& vm, const particle& recoil) const;
-
   // utility function
   lA_event make_event(const lA_data& initial, const double t, particle vm1,
                       particle X1, const double xs, const double R);
@@ -83,7 +79,13 @@ private:
 
   // t-range and cross setion maxima
   const interval<double> max_t_range_;
-  const double max_;
+  double max_;
+
+  // accept-reject envelope (optional)
+  std::unique_ptr<envelope> envelope_;
+
+  // scratch space for the batched interface
+  vm_trials trials_;
 };
 
 } // namespace lA
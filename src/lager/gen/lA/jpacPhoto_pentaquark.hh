@@ -46,8 +46,9 @@ public:
   using base_type = lA::generator;
 
   jpacPhoto_pentaquark(const configuration& cf, const string_path& path,
-                       std::shared_ptr<TRandom> r);
-  virtual lA_event generate(const lA_data&);
+                       std::shared_ptr<random_engine> r);
+  virtual void evaluate(const lA_block& block, std::vector<double>& xs);
+  virtual lA_event build(const lA_block& block, const size_t lane);
   virtual double max_cross_section() const { return max_; }
   virtual double phase_space() const { return max_t_range_.width(); }
 
@@ -65,9 +66,9 @@ private:
       ;
   double dipole(const double Q2) const;
 
-  // threshold squared for these particular particles (correctly handels the
-  // case of particles with non-zero width)
-  double threshold2(const particle& vm, const particle& recoil) const;
+  // generate a phase space point and evaluate the cross section for a lane,
+  // false if kinematically forbidden
+  bool trial(const lA_data& initial, const size_t lane);
 
   // utility function
   lA_event make_event(const lA_data& initial, const double t, particle vm1,
@@ -104,6 +105,9 @@ private:
   // t-range and cross section maxima
   const interval<double> max_t_range_;
   const double max_;
+
+  // scratch space for the batched interface
+  vm_trials trials_;
 };
 
 } // namespace lA
@@ -34,7 +34,7 @@ namespace lA {
 // =============================================================================
 jpacPhoto_pomeron::jpacPhoto_pomeron(const configuration& cf,
                                      const string_path& path,
-                                     std::shared_ptr<TRandom> r)
+                                     std::shared_ptr<random_engine> r)
     : base_type{r}
     , recoil_{cf.get<std::string>(path / "recoil_type")}
     , vm_{cf.get<std::string>(path / "vm_type")}
@@ -65,9 +65,9 @@ jpacPhoto_pomeron::jpacPhoto_pomeron(const configuration& cf,
            "photo slope parameter [1/GeV^2]: " + std::to_string(photo_slope_));
   LOG_INFO("jpacPhoto_pomeron",
            "'Dipole' FF power: " + std::to_string(dipole_n_));
-  LOG_INFO("jpacPhoto_pomeron", "VM: " + std::string(vm_.pdg()->GetName()));
+  LOG_INFO("jpacPhoto_pomeron", "VM: " + std::string(vm_.name()));
   LOG_INFO("jpacPhoto_pomeron",
-           "recoil: " + std::string(recoil_.pdg()->GetName()));
+           "recoil: " + std::string(recoil_.name()));
 }
 std::unique_ptr<jpacPhoto::reaction_kinematics>
 jpacPhoto_pomeron::init_reaction() const {
@@ -82,34 +82,56 @@ jpacPhoto::pomeron_exchange jpacPhoto_pomeron::init_ampl() {
   return ampl;
 }
 
-lA_event jpacPhoto_pomeron::generate(const lA_data& initial) {
+// =============================================================================
+// jpacPhoto_pomeron::evaluate(block, xs)
+// jpacPhoto_pomeron::build(block, lane)
+// =============================================================================
+void jpacPhoto_pomeron::evaluate(const lA_block& block,
+                                 std::vector<double>& xs) {
+  const size_t n = block.size();
+  trials_.resize(n);
+  xs.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    xs[i] = trial(block[i], i) ? block.cross_section(i, trials_.xs[i]) : 0.;
+  }
+}
+lA_event jpacPhoto_pomeron::build(const lA_block& block, const size_t lane) {
+  return make_event(block[lane], trials_.t[lane], trials_.vm[lane],
+                    trials_.recoil[lane], trials_.xs[lane]);
+}
+
+// =============================================================================
+// jpacPhoto_pomeron::trial(initial, lane)
+// =============================================================================
+bool jpacPhoto_pomeron::trial(const lA_data& initial, const size_t lane) {
   // generate a mass() in case of non-zero width, initialize the particles
-  particle vm = {vm_.type(), rng()};
-  particle recoil = {recoil_.type(), rng()};
+  trials_.generate(lane, vm_, recoil_, rng());
 
   // shortcuts
   const auto& gamma = initial.photon();
   const auto& target = initial.target();
 
   // check if enough energy available
-  if (gamma.W2() < threshold2(vm, recoil)) {
+  if (gamma.W2() < trials_.threshold2(lane)) {
     LOG_JUNK("jpacPhoto_pomeron", "Not enough phase space available - W2: " +
                                       std::to_string(gamma.W2()) + " < " +
-                                      std::to_string(threshold2(vm, recoil)));
-    return lA_event{0.};
+                                      std::to_string(trials_.threshold2(lane)));
+    reject(lane, rejection::THRESHOLD);
+    return false;
   }
 
   // generate a phase space point
-  const double t = rng()->Uniform(max_t_range_.min, max_t_range_.max);
+  const double t = rng().Uniform(max_t_range_.min, max_t_range_.max);
 
   LOG_JUNK("jpacPhoto_pomeron", "t: " + std::to_string(t));
 
   // check if kinematically allowed
   if (physics::t_range(gamma.W2(), gamma.Q2(), target.particle().mass(),
-                       vm.mass(), recoil.mass())
+                       trials_.Mv[lane], trials_.Mr[lane])
           .excludes(t)) {
     LOG_JUNK("jpacPhoto_pomeron", "t outside of the allowed range for this W2")
-    return lA_event{0.};
+    reject(lane, rejection::T_RANGE);
+    return false;
   }
 
   // evaluate the cross section
@@ -121,8 +143,9 @@ lA_event jpacPhoto_pomeron::generate(const lA_data& initial) {
            "xsec: " + std::to_string(xs_photo) + " < " + std::to_string(max_));
   LOG_JUNK("jpacPhoto_pomeron", "dipole: " + std::to_string(xs_dipole));
 
-  // return a new VM event
-  return make_event(initial, t, vm, recoil, xs);
+  trials_.t[lane] = t;
+  trials_.xs[lane] = xs;
+  return true;
 }
 
 // =============================================================================
@@ -218,18 +241,6 @@ double jpacPhoto_pomeron::dsigma_dt(const double s, const double t) /*const */ {
 double jpacPhoto_pomeron::dipole(const double Q2) const {
   return physics::dipole_ff_vm(Q2, vm_.mass(), dipole_n_);
 }
-// =============================================================================
-// jpacPhoto_pomeron::threshold2()
-//
-// utility function returns the production threshold squared for the chosen
-// particles. Important to re-calculate in case of a particle with non-zero
-// widht.
-// =============================================================================
-double jpacPhoto_pomeron::threshold2(const particle& vm,
-                                     const particle& recoil) const {
-  return recoil.mass2() + vm.mass2() + 2 * vm.mass() * recoil.mass();
-}
-
 // =============================================================================
 // create the lA_event data, calculates the final state four-vectors in
 // the lab-frame
@@ -269,7 +280,7 @@ lA_event jpacPhoto_pomeron::make_event(const lA_data& initial, const double t,
   const double ctheta_cm =
       (t + 2 * Et_cm * Er_cm - Mt2 - Mr2) / (2 * Pt_cm * Pr_cm);
   const double theta_cm = std::acos(ctheta_cm);
-  const double phi_cm = rng()->Uniform(0, TMath::TwoPi());
+  const double phi_cm = rng().Uniform(0, TMath::TwoPi());
 
   // create the CM 4-vectors
   const particle::Polar3DVector p3_v{Pv_cm, theta_cm, phi_cm};
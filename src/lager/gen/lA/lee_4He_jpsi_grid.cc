@@ -619,7 +619,7 @@ namespace lA {
 // =============================================================================
 lee_4He_jpsi_grid::lee_4He_jpsi_grid(const configuration& cf,
                                      const string_path& path,
-                                     std::shared_ptr<TRandom> r)
+                                     std::shared_ptr<random_engine> r)
     : base_type{r}
     , recoil_{pdg_id::He4}
     , vm_{pdg_id::J_psi}
@@ -637,40 +637,62 @@ lee_4He_jpsi_grid::lee_4He_jpsi_grid(const configuration& cf,
            "R_vm n-parameter (power): " + std::to_string(R_vm_n_));
   LOG_INFO("lee_4He_jpsi_grid",
            "'Dipole' FF power: " + std::to_string(dipole_n_));
-  LOG_INFO("lee_4He_jpsi_grid", "VM: " + std::string(vm_.pdg()->GetName()));
+  LOG_INFO("lee_4He_jpsi_grid", "VM: " + std::string(vm_.name()));
   LOG_INFO("lee_4He_jpsi_grid",
-           "recoil: " + std::string(recoil_.pdg()->GetName()));
+           "recoil: " + std::string(recoil_.name()));
 }
 
-lA_event lee_4He_jpsi_grid::generate(const lA_data& initial) {
+// =============================================================================
+// lee_4He_jpsi_grid::evaluate(block, xs)
+// lee_4He_jpsi_grid::build(block, lane)
+// =============================================================================
+void lee_4He_jpsi_grid::evaluate(const lA_block& block,
+                                 std::vector<double>& xs) {
+  const size_t n = block.size();
+  trials_.resize(n);
+  xs.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    xs[i] = trial(block[i], i) ? block.cross_section(i, trials_.xs[i]) : 0.;
+  }
+}
+lA_event lee_4He_jpsi_grid::build(const lA_block& block, const size_t lane) {
+  return make_event(block[lane], trials_.t[lane], trials_.vm[lane],
+                    trials_.recoil[lane], trials_.xs[lane], trials_.R[lane]);
+}
+
+// =============================================================================
+// lee_4He_jpsi_grid::trial(initial, lane)
+// =============================================================================
+bool lee_4He_jpsi_grid::trial(const lA_data& initial, const size_t lane) {
 
   // generate a mass() in case of non-zero width, initialize the particles
-  particle vm = {vm_.type(), rng()};
-  particle recoil = {recoil_.type(), rng()};
+  trials_.generate(lane, vm_, recoil_, rng());
 
   // shortcuts
   const auto& gamma = initial.photon();
   const auto& target = initial.target();
 
   // check if enough energy available
-  if (gamma.W2() < threshold2(vm, recoil)) {
+  if (gamma.W2() < trials_.threshold2(lane)) {
     LOG_JUNK("lee_4He_jpsi_grid", "Not enough phase space available - W2: " +
                                       std::to_string(gamma.W2()) + " < " +
-                                      std::to_string(threshold2(vm, recoil)));
-    return lA_event{0.};
+                                      std::to_string(trials_.threshold2(lane)));
+    reject(lane, rejection::THRESHOLD);
+    return false;
   }
 
   // generate a phase space point
-  const double t = rng()->Uniform(max_t_range_.min, max_t_range_.max);
+  const double t = rng().Uniform(max_t_range_.min, max_t_range_.max);
 
   LOG_JUNK("lee_4He_jpsi_grid", "t: " + std::to_string(t));
 
   // check if kinematically allowed
-  if (physics::t_range(gamma.W2(), gamma.Q2(), target.particle().mass(), vm.mass(),
-                       recoil.mass())
+  if (physics::t_range(gamma.W2(), gamma.Q2(), target.particle().mass(),
+                       trials_.Mv[lane], trials_.Mr[lane])
           .excludes(t)) {
     LOG_JUNK("lee_4He_jpsi_grid", "t outside of the allowed range for this W2")
-    return lA_event{0.};
+    reject(lane, rejection::T_RANGE);
+    return false;
   }
 
   // evaluate the cross section
@@ -684,8 +706,10 @@ lA_event lee_4He_jpsi_grid::generate(const lA_data& initial) {
   LOG_JUNK("lee_4He_jpsi_grid", "R: " + std::to_string(xs_R));
   LOG_JUNK("lee_4He_jpsi_grid", "dipole: " + std::to_string(xs_dipole));
 
-  // return a new VM event
-  return make_event(initial, t, vm, recoil, xs, xs_R);
+  trials_.t[lane] = t;
+  trials_.xs[lane] = xs;
+  trials_.R[lane] = xs_R;
+  return true;
 }
 
 // =============================================================================
@@ -799,19 +823,6 @@ double lee_4He_jpsi_grid::R(const double Q2) const {
 double lee_4He_jpsi_grid::dipole(const double Q2) const {
   return physics::dipole_ff_vm(Q2, vm_.mass(), dipole_n_);
 }
-// =============================================================================
-// lee_4He_jpsi_grid::threshold2()
-//
-// utility function returns the production threshold squared for the chosen
-// particles. Important to re-calculate in case of a particle with non-zero
-// widht.
-// =============================================================================
-double lee_4He_jpsi_grid::threshold2(const particle& vm,
-                                     const particle& recoil) const {
-
-  return recoil.mass2() + vm.mass2() + 2 * vm.mass() * recoil.mass();
-}
-
 // =============================================================================
 // create the lA_event dataf, calculates the final state four-vectors in
 // the lab-frame
@@ -854,7 +865,7 @@ lA_event lee_4He_jpsi_grid::make_event(const lA_data& initial,
   const double ctheta_cm =
       (t + 2 * Et_cm * Er_cm - Mt2 - Mr2) / (2 * Pt_cm * Pr_cm);
   const double theta_cm = std::acos(ctheta_cm);
-  const double phi_cm = rng()->Uniform(0, TMath::TwoPi());
+  const double phi_cm = rng().Uniform(0, TMath::TwoPi());
 
   // create the CM 4-vectors
   const particle::Polar3DVector p3_v{Pv_cm, theta_cm, phi_cm};
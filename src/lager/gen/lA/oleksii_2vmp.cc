@@ -238,7 +238,7 @@ private:
 // Constructor for lA::oleksii_2vmp
 // =============================================================================
 oleksii_2vmp::oleksii_2vmp(const configuration& cf, const string_path& path,
-                           std::shared_ptr<TRandom> r)
+                           std::shared_ptr<random_engine> r)
     : base_type{r}
     , recoil_{pdg_id::p}
     , vm_{cf.get<std::string>(path / "vm_type")}
@@ -264,31 +264,53 @@ oleksii_2vmp::oleksii_2vmp(const configuration& cf, const string_path& path,
   LOG_INFO("oleksii_2vmp",
            "R_vm n-parameter (power): " + std::to_string(R_vm_n_));
   LOG_INFO("oleksii_2vmp", "'Dipole' FF power: " + std::to_string(dipole_n_));
-  LOG_INFO("oleksii_2vmp", "VM: " + std::string(vm_.pdg()->GetName()));
-  LOG_INFO("oleksii_2vmp", "recoil: " + std::string(recoil_.pdg()->GetName()));
+  LOG_INFO("oleksii_2vmp", "VM: " + std::string(vm_.name()));
+  LOG_INFO("oleksii_2vmp", "recoil: " + std::string(recoil_.name()));
 }
 
-lA_event oleksii_2vmp::generate(const lA_data& initial) {
+// =============================================================================
+// oleksii_2vmp::evaluate(block, xs)
+// oleksii_2vmp::build(block, lane)
+// =============================================================================
+void oleksii_2vmp::evaluate(const lA_block& block, std::vector<double>& xs) {
+  const size_t n = block.size();
+  trials_.resize(n);
+  trial_b_.resize(n);
+  xs.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    xs[i] = trial(block[i], i) ? block.cross_section(i, trials_.xs[i]) : 0.;
+  }
+}
+lA_event oleksii_2vmp::build(const lA_block& block, const size_t lane) {
+  return make_event(block[lane], trials_.t[lane], trial_b_[lane],
+                    trials_.vm[lane], trials_.recoil[lane], trials_.xs[lane],
+                    trials_.R[lane]);
+}
+
+// =============================================================================
+// oleksii_2vmp::trial(initial, lane)
+// =============================================================================
+bool oleksii_2vmp::trial(const lA_data& initial, const size_t lane) {
 
   // generate a mass() in case of non-zero width, initialize the particles
-  particle vm = {vm_.type(), rng()};
-  particle recoil = {recoil_.type(), rng()};
+  trials_.generate(lane, vm_, recoil_, rng());
 
   // shortcuts
   const auto& gamma = initial.photon();
   const auto& target = initial.target();
 
   // check if enough energy available
-  if (gamma.W2() < threshold2(vm, recoil)) {
+  if (gamma.W2() < trials_.threshold2(lane)) {
     LOG_JUNK("oleksii_2vmp", "Not enough phase space available - W2: " +
                                  std::to_string(gamma.W2()) + " < " +
-                                 std::to_string(threshold2(vm, recoil)));
-    return lA_event{0.};
+                                 std::to_string(trials_.threshold2(lane)));
+    reject(lane, rejection::THRESHOLD);
+    return false;
   }
 
   // generate a phase space point
   const double t =
-      std::log(rng()->Uniform(max_exp_b0t_range_.min, max_exp_b0t_range_.max)) /
+      std::log(rng().Uniform(max_exp_b0t_range_.min, max_exp_b0t_range_.max)) /
       max_b_range_.min;
   const double b = slope_->B(gamma.W(), gamma.Q2());
 
@@ -297,10 +319,11 @@ lA_event oleksii_2vmp::generate(const lA_data& initial) {
 
   // check if kinematically allowed
   if (physics::t_range(gamma.W2(), gamma.Q2(), target.particle().mass(),
-                       vm.mass(), recoil.mass())
+                       trials_.Mv[lane], trials_.Mr[lane])
           .excludes(t)) {
     LOG_JUNK("oleksii_2vmp", "t outside of the allowed range for this W2")
-    return lA_event{0.};
+    reject(lane, rejection::T_RANGE);
+    return false;
   }
 
   // evaluate the cross section
@@ -314,8 +337,11 @@ lA_event oleksii_2vmp::generate(const lA_data& initial) {
   LOG_JUNK("oleksii_2vmp", "R: " + std::to_string(xs_R));
   LOG_JUNK("oleksii_2vmp", "dipole: " + std::to_string(xs_dipole));
 
-  // return a new VM event
-  return make_event(initial, t, b, vm, recoil, xs, xs_R);
+  trials_.t[lane] = t;
+  trials_.xs[lane] = xs;
+  trials_.R[lane] = xs_R;
+  trial_b_[lane] = b;
+  return true;
 }
 
 interval<double> oleksii_2vmp::calc_max_b_range(const configuration& cf) const {
@@ -456,19 +482,6 @@ double oleksii_2vmp::R(const double Q2) const {
 double oleksii_2vmp::dipole(const double Q2) const {
   return physics::dipole_ff_vm(Q2, vm_.mass(), dipole_n_);
 }
-// =============================================================================
-// oleksii_2vmp::threshold2()
-//
-// utility function returns the production threshold squared for the chosen
-// particles. Important to re-calculate in case of a particle with non-zero
-// widht.
-// =============================================================================
-double oleksii_2vmp::threshold2(const particle& vm,
-                                const particle& recoil) const {
-
-  return recoil.mass2() + vm.mass2() + 2 * vm.mass() * recoil.mass();
-}
-
 // =============================================================================
 // create the lA_event dataf, calculates the final state four-vectors in
 // the lab-frame
@@ -510,7 +523,7 @@ lA_event oleksii_2vmp::make_event(const lA_data& initial, const double t,
   const double ctheta_cm =
       (t + 2 * Et_cm * Er_cm - Mt2 - Mr2) / (2 * Pt_cm * Pr_cm);
   const double theta_cm = std::acos(ctheta_cm);
-  const double phi_cm = rng()->Uniform(0, TMath::TwoPi());
+  const double phi_cm = rng().Uniform(0, TMath::TwoPi());
 
   // create the CM 4-vectors
   const particle::Polar3DVector p3_v{Pv_cm, theta_cm, phi_cm};
@@ -50,8 +50,9 @@ public:
   using base_type = lA::generator;
 
   oleksii_2vmp(const configuration& cf, const string_path& path,
-               std::shared_ptr<TRandom> r);
-  virtual lA_event generate(const lA_data&);
+               std::shared_ptr<random_engine> r);
+  virtual void evaluate(const lA_block& block, std::vector<double>& xs);
+  virtual lA_event build(const lA_block& block, const size_t lane);
   virtual double max_cross_section() const { return max_; }
   virtual double phase_space() const { return max_exp_b0t_range_.width(); }
 
@@ -77,9 +78,9 @@ private:
   // jacobian (equal to unity)
   double jacobian(const double t) const;
 
-  // threshold squared for these particular particles (correctly handels the
-  // case of particles with non-zero width)
-  double threshold2(const particle& vm, const particle& recoil) const;
+  // generate a phase space point and evaluate the cross section for a lane,
+  // false if kinematically forbidden
+  bool trial(const lA_data& initial, const size_t lane);
 
   // utility function
   lA_event make_event(const lA_data& initial, const double t,
@@ -105,6 +106,10 @@ private:
   const interval<double> max_t_range_;
   const interval<double> max_exp_b0t_range_;
   const double max_;
+
+  // scratch space for the batched interface
+  vm_trials trials_;
+  std::vector<double> trial_b_;
 };
 
 } // namespace lA
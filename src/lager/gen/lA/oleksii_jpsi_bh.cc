@@ -38,7 +38,7 @@ namespace lA {
 // =============================================================================
 oleksii_jpsi_bh::oleksii_jpsi_bh(const configuration& cf,
                                  const string_path& path,
-                                 std::shared_ptr<TRandom> r)
+                                 std::shared_ptr<random_engine> r)
     : base_type{r}
     , recoil_{pdg_id::p}
     , vm_{pdg_id::J_psi}
@@ -68,7 +68,30 @@ oleksii_jpsi_bh::oleksii_jpsi_bh(const configuration& cf,
                                   std::to_string(p_range_.max) + "]");
 }
 
-lA_event oleksii_jpsi_bh::generate(const lA_data& initial) {
+// =============================================================================
+// oleksii_jpsi_bh::evaluate(block, xs)
+// oleksii_jpsi_bh::build(block, lane)
+// =============================================================================
+void oleksii_jpsi_bh::evaluate(const lA_block& block, std::vector<double>& xs) {
+  const size_t n = block.size();
+  trials_.resize(n);
+  trial_thetaCM_.resize(n);
+  trial_phiCM_.resize(n);
+  xs.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    xs[i] = trial(block[i], i) ? block.cross_section(i, trials_.xs[i]) : 0.;
+  }
+}
+lA_event oleksii_jpsi_bh::build(const lA_block& block, const size_t lane) {
+  return make_event(block[lane], trials_.t[lane], trials_.vm[lane],
+                    trials_.recoil[lane], trials_.xs[lane],
+                    trial_thetaCM_[lane], trial_phiCM_[lane]);
+}
+
+// =============================================================================
+// oleksii_jpsi_bh::trial(initial, lane)
+// =============================================================================
+bool oleksii_jpsi_bh::trial(const lA_data& initial, const size_t lane) {
 
   // particle vm = {};
   particle recoil = {pdg_id::p};
@@ -82,7 +105,7 @@ lA_event oleksii_jpsi_bh::generate(const lA_data& initial) {
           "oleksii_jpsi_bh is a photo-production only generator!");
 
   // generate a Mll point
-  const double Mll2 = rng()->Uniform(Mll_range_.min * Mll_range_.min,
+  const double Mll2 = rng().Uniform(Mll_range_.min * Mll_range_.min,
                                      Mll_range_.max * Mll_range_.max);
   const double Mll = sqrt(Mll2);
 
@@ -97,22 +120,23 @@ lA_event oleksii_jpsi_bh::generate(const lA_data& initial) {
     LOG_JUNK("oleksii_jpsi_bh", "Not enough phase space available - W2: " +
                                     std::to_string(gamma.W2()) + " < " +
                                     std::to_string(threshold2(vm, recoil)));
-    return lA_event{0.};
+    reject(lane, rejection::THRESHOLD);
+    return false;
   }
 
-  const double t = std::log(rng()->Uniform(std::exp(1.13 * max_t_range_.min),
+  const double t = std::log(rng().Uniform(std::exp(1.13 * max_t_range_.min),
                                            std::exp(1.13 * max_t_range_.max))) /
                    1.13;
   const double jacobian = exp(-1.13 * t) / 1.13;
   // further generate this phase space point
-  // const double t = std::log(rng()->Uniform(std::exp(5 * max_t_range_.min),
+  // const double t = std::log(rng().Uniform(std::exp(5 * max_t_range_.min),
   //                                         std::exp(5 * max_t_range_.max)))
   //                                         /
   //                 5.;
-  // const double t = rng()->Uniform(max_t_range_.min, max_t_range_.max);
-  // const double thetaCM = acos(rng()->Uniform(-0.766, -0.707));
-  const double thetaCM = acos(rng()->Uniform(-1., 1.));
-  const double phiCM = rng()->Uniform(0, TMath::TwoPi());
+  // const double t = rng().Uniform(max_t_range_.min, max_t_range_.max);
+  // const double thetaCM = acos(rng().Uniform(-0.766, -0.707));
+  const double thetaCM = acos(rng().Uniform(-1., 1.));
+  const double phiCM = rng().Uniform(0, TMath::TwoPi());
 
   LOG_JUNK("oleksii_jpsi_bh", "t: " + std::to_string(t));
   LOG_JUNK("oleksii_jpsi_bh", "thetaCM: " + std::to_string(thetaCM));
@@ -123,7 +147,8 @@ lA_event oleksii_jpsi_bh::generate(const lA_data& initial) {
                                vm.mass(), recoil.mass());
   if (tlim.excludes(t)) {
     LOG_JUNK("oleksii_jpsi_bh", "t outside of the allowed range for this W2");
-    return lA_event{0.};
+    reject(lane, rejection::T_RANGE);
+    return false;
   }
 
   // invariant definition of Egamma
@@ -137,8 +162,13 @@ lA_event oleksii_jpsi_bh::generate(const lA_data& initial) {
   LOG_JUNK("oleksii_jpsi_bh",
            "xsec: " + std::to_string(xs) + " < " + std::to_string(max_));
 
-  // return a new VM event
-  return make_event(initial, t, vm, recoil, xs * jacobian, thetaCM, phiCM);
+  trials_.vm[lane] = vm;
+  trials_.recoil[lane] = recoil;
+  trials_.t[lane] = t;
+  trials_.xs[lane] = xs * jacobian;
+  trial_thetaCM_[lane] = thetaCM;
+  trial_phiCM_[lane] = phiCM;
+  return true;
 }
 
 // =============================================================================
@@ -242,7 +272,7 @@ lA_event oleksii_jpsi_bh::make_event(const lA_data& initial,
   const double ctheta_cm =
       (t + 2 * Et_cm * Er_cm - Mt2 - Mr2) / (2 * Pt_cm * Pr_cm);
   const double theta_cm = std::acos(ctheta_cm);
-  const double phi_cm = rng()->Uniform(0, TMath::TwoPi());
+  const double phi_cm = rng().Uniform(0, TMath::TwoPi());
 
   // create the CM 4-vectors
   const particle::Polar3DVector p3_v{Pv_cm, theta_cm, phi_cm};
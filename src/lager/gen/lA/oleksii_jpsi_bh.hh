@@ -46,8 +46,9 @@ public:
   using base_type = lA::generator;
 
   oleksii_jpsi_bh(const configuration& cf, const string_path& path,
-                  std::shared_ptr<TRandom> r);
-  virtual lA_event generate(const lA_data&);
+                  std::shared_ptr<random_engine> r);
+  virtual void evaluate(const lA_block& block, std::vector<double>& xs);
+  virtual lA_event build(const lA_block& block, const size_t lane);
   virtual double max_cross_section() const { return max_; }
   virtual double phase_space() const {
     // last factor is the cos(theta) range
@@ -64,6 +65,10 @@ private:
   // case of particles with non-zero width)
   double threshold2(const particle& vm, const particle& recoil) const;
 
+  // generate a phase space point and evaluate the cross section for a lane,
+  // false if kinematically forbidden
+  bool trial(const lA_data& initial, const size_t lane);
+
   // utility function
   lA_event make_event(const lA_data& initial, const double t,
                             particle vm1, particle X1, const double xs,
@@ -85,6 +90,11 @@ private:
   // theta acceptance to cut out colinear enhancements
   const interval<double> p_range_;
   const interval<double> theta_range_;
+
+  // scratch space for the batched interface
+  vm_trials trials_;
+  std::vector<double> trial_thetaCM_;
+  std::vector<double> trial_phiCM_;
 };
 
 } // namespace lA
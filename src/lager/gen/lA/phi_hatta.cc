@@ -33,7 +33,7 @@ namespace lA {
 // Constructor for lA::phi_hatta
 // =============================================================================
 phi_hatta::phi_hatta(const configuration& cf, const string_path& path,
-                       std::shared_ptr<TRandom> r)
+                       std::shared_ptr<random_engine> r)
     : base_type{r}
     , recoil_{cf.get<std::string>(path / "recoil_type")}
     , vm_{cf.get<std::string>(path / "vm_type")}
@@ -55,74 +55,96 @@ phi_hatta::phi_hatta(const configuration& cf, const string_path& path,
   const std::string ff = cf.get<std::string>(path / "ff" / "function");
   LOG_INFO("phi_hatta", "FF function: " + ff);
   if (ff == "exp") {
-    const double B0 = cf.get<double>(path / "ff" / "B0");
-    const double alphaP = cf.get<double>(path / "ff" / "alphaP");
-    LOG_INFO("phi_hatta", "FF B0 parameter" + std::to_string(B0));
-    LOG_INFO("phi_hatta", "FF alphaP parameter" + std::to_string(alphaP));
-    ff_func_ = [=, *this](double Q2, double W, double t, double Mt) -> double {
-      return physics::exp_ff_normalized(Q2, W, t, Mt, vm_.mass(), B0, alphaP);
-    };
+    ff_type_ = ff_type::EXP;
+    ff_B0_ = cf.get<double>(path / "ff" / "B0");
+    ff_alphaP_ = cf.get<double>(path / "ff" / "alphaP");
+    LOG_INFO("phi_hatta", "FF B0 parameter" + std::to_string(ff_B0_));
+    LOG_INFO("phi_hatta", "FF alphaP parameter" + std::to_string(ff_alphaP_));
   } else if (ff == "dipole") {
-    const double Mg2 = cf.get<double>(path / "ff" / "Mg2");
-    LOG_INFO("phi_hatta", "FF Mg^2 parameter" + std::to_string(Mg2));
-    ff_func_ = [=, *this](double Q2, double W, double t, double Mt) -> double {
-      return physics::dipole_ff_normalized(Q2, W, t, Mt, vm_.mass(), Mg2);
-    };
+    ff_type_ = ff_type::DIPOLE;
+    ff_Mg2_ = cf.get<double>(path / "ff" / "Mg2");
+    LOG_INFO("phi_hatta", "FF Mg^2 parameter" + std::to_string(ff_Mg2_));
   } else {
     throw cf.value_error("ff/function", ff);
   }
-  LOG_INFO("phi_hatta", "VM: " + std::string(vm_.pdg()->GetName()));
-  LOG_INFO("phi_hatta", "recoil: " + std::string(recoil_.pdg()->GetName()));
+  LOG_INFO("phi_hatta", "VM: " + std::string(vm_.name()));
+  LOG_INFO("phi_hatta", "recoil: " + std::string(recoil_.name()));
+  // accept-reject envelope (if enabled), the envelope maximum replaces the
+  // cross section maximum
+  envelope_ = make_vm_envelope(
+      cf, path, vm_, recoil_, max_t_range_,
+      [this](const double W, const double Q2, const double t,
+             const double Mt) {
+        const double Mv = vm_.mass();
+        return (1 + physics::R_phi_hatta(Q2, Mv, c_R_)) *
+               physics::sigmaT_phi_hatta(Q2, W, Mt, Mv, alpha_1_, alpha_2_,
+                                         alpha_3_, nu_T_) *
+               this->ff(Q2, W, t, Mt);
+      });
+  if (envelope_) {
+    max_ = envelope_->max();
+  }
 }
 
-lA_event phi_hatta::generate(const lA_data& initial) {
+// =============================================================================
+// phi_hatta::evaluate(block, xs)
+// phi_hatta::build(block, lane)
+// =============================================================================
+void phi_hatta::evaluate(const lA_block& block, std::vector<double>& xs) {
+  const size_t n = block.size();
+  xs.resize(n);
 
-  // generate a mass() in case of non-zero width, initialize the particles
-  particle vm = {vm_.type(), rng()};
-  particle recoil = {recoil_.type(), rng()};
-  //LOG_INFO("phi_hatta", "HK WAS HERE ");
-  // shortcuts
-  const auto& gamma = initial.photon();
-  const auto& target = initial.target();
+  // generate the VM and recoil particles and the phase space points
+  trials_.generate(block, vm_, recoil_, max_t_range_, envelope_.get(), rng());
 
-  // check if enough energy available
-  if (gamma.W2() < threshold2(vm, recoil)) {
-    LOG_JUNK("phi_hatta", "Not enough phase space available - W2: " +
-                               std::to_string(gamma.W2()) + " < " +
-                               std::to_string(threshold2(vm, recoil)));
-    return lA_event{0.};
+  // evaluate the cross section
+  const double Mv = vm_.mass();
+  for (size_t i = 0; i < n; ++i) {
+    const double W = block.W()[i];
+    const double W2 = block.W2()[i];
+    const double Q2 = block.Q2()[i];
+    const double Mt = block.Mt()[i];
+    const double t = trials_.t[i];
+    // check if enough energy available, and if t is kinematically allowed
+    const bool allowed =
+        W2 >= trials_.threshold2(i) &&
+        physics::t_range(W2, Q2, Mt, trials_.Mv[i], trials_.Mr[i])
+            .includes(t);
+    const double R = physics::R_phi_hatta(Q2, Mv, c_R_);
+    const double sigmaT = physics::sigmaT_phi_hatta(
+        Q2, W, Mt, Mv, alpha_1_, alpha_2_, alpha_3_, nu_T_);
+    const double xs_proc =
+        (1 + block.epsilon()[i] * R) * sigmaT * ff(Q2, W, t, Mt);
+    trials_.R[i] = R;
+    trials_.xs[i] = allowed ? xs_proc * trials_.jacobian[i] : 0.;
+    if (!allowed) {
+      reject(i, (W2 < trials_.threshold2(i)) ? rejection::THRESHOLD
+                                             : rejection::T_RANGE);
+    }
+    xs[i] = block.cross_section(i, trials_.xs[i]);
   }
+}
+lA_event phi_hatta::build(const lA_block& block, const size_t lane) {
+  lA_event e = make_event(block[lane], trials_.t[lane], trials_.vm[lane],
+                          trials_.recoil[lane], trials_.xs[lane],
+                          trials_.R[lane]);
+  // undo the envelope jacobian for the output cross section
+  e.update_jacobian(1. / trials_.jacobian[lane]);
+  return e;
+}
 
-  // generate a phase space point
-  const double t = rng()->Uniform(max_t_range_.min, max_t_range_.max);
-
-  LOG_JUNK("phi_hatta", "t: " + std::to_string(t));
-
-  // check if kinematically allowed
-  if (physics::t_range(gamma.W2(), gamma.Q2(), target.particle().mass(),
-                       vm.mass(), recoil.mass())
-          .excludes(t)) {
-    LOG_JUNK("phi_hatta", "t outside of the allowed range for this W2")
-    return lA_event{0.};
+// =============================================================================
+// phi_hatta::ff()
+//
+// normalized t-dependence, exponential or dipole
+// =============================================================================
+double phi_hatta::ff(const double Q2, const double W, const double t,
+                     const double Mt) const {
+  if (ff_type_ == ff_type::EXP) {
+    return physics::exp_ff_normalized(Q2, W, t, Mt, vm_.mass(), ff_B0_,
+                                      ff_alphaP_);
   }
-
-  // evaluate the cross section
-  const double R = physics::R_phi_hatta(gamma.Q2(), vm_.mass(), c_R_);
-  const double sigmaT =
-      physics::sigmaT_phi_hatta(gamma.Q2(), gamma.W(), target.particle().mass(),
-                               vm_.mass(), alpha_1_, alpha_2_, alpha_3_, nu_T_);
-  const double ff =
-      ff_func_(gamma.Q2(), gamma.W(), t, target.particle().mass());
-  const double xs = (1 + gamma.epsilon() * R) * sigmaT * ff;
-
-  LOG_JUNK("phi_hatta",
-           "xsec: " + std::to_string(xs) + " < " + std::to_string(max_));
-  LOG_JUNK("phi_hatta", "sigmaT: " + std::to_string(sigmaT));
-  LOG_JUNK("phi_hatta", "R: " + std::to_string(R));
-  LOG_JUNK("phi_hatta", "ff: " + std::to_string(ff));
-
-  // return a new VM event
-  return make_event(initial, t, vm, recoil, xs, R);
+  return physics::dipole_ff_normalized(Q2, W, t, Mt, vm_.mass(), ff_Mg2_);
 }
 
 // =============================================================================
@@ -206,19 +228,6 @@ interval<double> phi_hatta::calc_max_t_range(const configuration& cf,
                   : interval<double>{tlim1.min, tlim2.max};
   return tlim;
 }
-// =============================================================================
-// phi_hatta::threshold2()
-//
-// utility function returns the production threshold squared for the chosen
-// particles. Important to re-calculate in case of a particle with non-zero
-// widht.
-// =============================================================================
-double phi_hatta::threshold2(const particle& vm,
-                              const particle& recoil) const {
-
-  return recoil.mass2() + vm.mass2() + 2 * vm.mass() * recoil.mass();
-}
-
 // =============================================================================
 // create the lA_event dataf, calculates the final state four-vectors in
 // the lab-frame
@@ -258,7 +267,7 @@ lA_event phi_hatta::make_event(const lA_data& initial, const double t,
   const double ctheta_cm =
       (t + 2 * Et_cm * Er_cm - Mt2 - Mr2) / (2 * Pt_cm * Pr_cm);
   const double theta_cm = std::acos(ctheta_cm);
-  const double phi_cm = rng()->Uniform(0, TMath::TwoPi());
+  const double phi_cm = rng().Uniform(0, TMath::TwoPi());
 
   // create the CM 4-vectors
   const particle::Polar3DVector p3_v{Pv_cm, theta_cm, phi_cm};
@@ -46,8 +46,9 @@ public:
   using base_type = lA::generator;
 
   phi_hatta(const configuration& cf, const string_path& path,
-             std::shared_ptr<TRandom> r);
-  virtual lA_event generate(const lA_data&);
+             std::shared_ptr<random_engine> r);
+  virtual void evaluate(const lA_block& block, std::vector<double>& xs);
+  virtual lA_event build(const lA_block& block, const size_t lane);
   virtual double max_cross_section() const { return max_; }
   virtual double phase_space() const { return max_t_range_.width(); }
 
@@ -55,10 +56,9 @@ private:
   double calc_max_xsec(const configuration& cf) const;
   interval<double> calc_max_t_range(const configuration& cf, const string_path& path) const;
 
-  // FIXME this should be a general utility function
-  // threshold squared for these particular particles (correctly handels the
-  // case of particles with non-zero width)
-  double threshold2(const particle& vm, const particle& recoil) const;
+  // normalized t-dependence
+  double ff(const double Q2, const double W, const double t,
+            const double Mt) const;
 
   // utility function
   lA_event make_event(const lA_data& initial, const double t, particle vm1,
@@ -75,14 +75,22 @@ private:
   const double nu_T_;
   // R settings
   const double c_R_;
-  // FF function
-  std::function<double(double /*Q2*/, double /*W*/, double /*t*/,
-                       double /*Mt*/)>
-      ff_func_;
+  // FF function and settings
+  enum class ff_type { EXP, DIPOLE };
+  ff_type ff_type_{ff_type::EXP};
+  double ff_B0_{0.};
+  double ff_alphaP_{0.};
+  double ff_Mg2_{0.};
 
   // t-range and cross setion maxima
   const interval<double> max_t_range_;
-  const double max_;
+  double max_;
+
+  // accept-reject envelope (optional)
+  std::unique_ptr<envelope> envelope_;
+
+  // scratch space for the batched interface
+  vm_trials trials_;
 };
 
 } // namespace lA
@@ -32,7 +32,7 @@ namespace lA {
 // Constructor for lA::resonance_qpq
 // =============================================================================
 resonance_qpq::resonance_qpq(const configuration& cf, const string_path& path,
-                             std::shared_ptr<TRandom> r)
+                             std::shared_ptr<random_engine> r)
     : base_type{r}
     , vm_pole_{cf.get<std::string>(path / "vm_type")}
     , qpq_{cf.get<std::string>(path / "qpq_type"),
@@ -56,12 +56,34 @@ resonance_qpq::resonance_qpq(const configuration& cf, const string_path& path,
            "R_vm n-parameter (power): " + std::to_string(R_vm_n_));
   LOG_INFO("resonance_qpq", "'Dipole' FF power: " + std::to_string(dipole_n_));
   LOG_INFO("resonance_qpq",
-           "Q-Pentaquark: " + std::string(qpq_.pdg()->GetName()));
+           "Q-Pentaquark: " + std::string(qpq_.name()));
   LOG_INFO("resonance_qpq",
-           "VM Pole: " + std::string(vm_pole_.pdg()->GetName()));
+           "VM Pole: " + std::string(vm_pole_.name()));
 }
 
-lA_event resonance_qpq::generate(const lA_data& initial) {
+// =============================================================================
+// resonance_qpq::evaluate(block, xs)
+// resonance_qpq::build(block, lane)
+// =============================================================================
+void resonance_qpq::evaluate(const lA_block& block, std::vector<double>& xs) {
+  const size_t n = block.size();
+  trial_xs_.resize(n);
+  trial_R_.resize(n);
+  xs.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    xs[i] = trial(block[i], i) ? block.cross_section(i, trial_xs_[i]) : 0.;
+  }
+}
+lA_event resonance_qpq::build(const lA_block& block, const size_t lane) {
+  return make_event(block[lane], trial_xs_[lane], trial_R_[lane]);
+}
+
+// =============================================================================
+// resonance_qpq::trial(initial, lane)
+//
+// Returns false if outside of the W2 range.
+// =============================================================================
+bool resonance_qpq::trial(const lA_data& initial, const size_t lane) {
   const auto& gamma = initial.photon();
 
   // check if we are in the correct W2 range
@@ -70,11 +92,11 @@ lA_event resonance_qpq::generate(const lA_data& initial) {
              "Event outside of W2 range - W2: " + std::to_string(gamma.W2()) +
                  " outside of [" + std::to_string(W2_range_.min) + ", " +
                  std::to_string(W2_range_.max) + "]");
-    return lA_event{0.};
+    return false;
   }
 
   // no generation step necessary, we just have to evaluate the cross section
-  // and create the Q-Pq
+  // (the Q-Pq is only created at event building)
 
   // evaluate the cross section
   const double xs_R = R(gamma.Q2());
@@ -87,8 +109,19 @@ lA_event resonance_qpq::generate(const lA_data& initial) {
   LOG_JUNK("resonance_qpq", "R: " + std::to_string(xs_R));
   LOG_JUNK("resonance_qpq", "dipole: " + std::to_string(xs_dipole));
 
-  // create our new event
-  lA_event e{initial, xs, 1., xs_R};
+  trial_xs_[lane] = xs;
+  trial_R_[lane] = xs_R;
+  return true;
+}
+
+// =============================================================================
+// resonance_qpq::make_event(initial, xs, R)
+//
+// create the lA_event with the Q-Pq
+// =============================================================================
+lA_event resonance_qpq::make_event(const lA_data& initial, const double xs,
+                                   const double R) {
+  lA_event e{initial, xs, 1., R};
   int qpq_idx = e.add_daughter(
       {qpq_.type(), e.photon().p() + e.target().p(), qpq_.status()},
       e.photon_index(), e.target_index());
@@ -46,8 +46,9 @@ class resonance_qpq : public lA::generator {
 public:
   using base_type = lA::generator;
   resonance_qpq(const configuration& cf, const string_path& path,
-                std::shared_ptr<TRandom> r);
-  virtual lA_event generate(const lA_data&);
+                std::shared_ptr<random_engine> r);
+  virtual void evaluate(const lA_block& block, std::vector<double>& xs);
+  virtual lA_event build(const lA_block& block, const size_t lane);
   virtual double max_cross_section() const { return max_; }
   virtual double phase_space() const { return 1.; }
 
@@ -61,6 +62,13 @@ private:
   double R(const double Q2) const;
   double dipole(const double Q2) const;
 
+  // evaluate the cross section for a lane, false if outside of the W2 range
+  bool trial(const lA_data& initial, const size_t lane);
+
+  // utility function
+  lA_event make_event(const lA_data& initial, const double xs,
+                      const double R);
+
   // recoil and  particle info
   const particle vm_pole_;          // relevant VM pole
   const particle qpq_;              // quarkonium pentaquark assumption
@@ -79,6 +87,10 @@ private:
 
 
   const double max_;
+
+  // scratch space for the batched interface
+  std::vector<double> trial_xs_;
+  std::vector<double> trial_R_;
 };
 
 } // namespace lA
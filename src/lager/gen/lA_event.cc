@@ -25,11 +25,13 @@ namespace lager {
 // IMPLEMENTATION: event_out
 // =============================================================================
 lA_out::lA_out(std::shared_ptr<TFile> f,
-               std::unique_ptr<HepMC3::WriterAscii> ohepmc,
-               std::unique_ptr<std::ofstream> ogemc,
-               std::unique_ptr<std::ofstream> osimc, const std::string& name)
+               std::unique_ptr<hepmc_out> ohepmc,
+               std::unique_ptr<text_writer> ogemc,
+               std::unique_ptr<text_writer> osimc, const std::string& name,
+               const position& start, const particle_layout layout,
+               const output_format format)
     : event_out{f, std::move(ohepmc), std::move(ogemc), std::move(osimc),
-                name} {
+                name, start, layout, format} {
   create_branches();
 }
 
@@ -72,34 +74,34 @@ void lA_out::push(const lA_event& e) {
 }
 
 void lA_out::create_branches() {
-  tree()->Branch("W", &W_);
-  tree()->Branch("Q2", &Q2_);
-  tree()->Branch("nu", &nu_);
-  tree()->Branch("x", &x_);
-  tree()->Branch("y", &y_);
-  tree()->Branch("epsilon", &epsilon_);
-  tree()->Branch("R", &R_);
-  tree()->Branch("t", &t_);
-  tree()->Branch("xv", &xv_);
-  tree()->Branch("Q2plusM2", &Q2plusM2_);
-  tree()->Branch("target_index", &target_index_);
-  tree()->Branch("photon_index", &photon_index_);
-  tree()->Branch("scat_index", &scat_index_);
-  tree()->Branch("leading_index", &leading_index_);
-  tree()->Branch("recoil_index", &recoil_index_);
+  branch("W", &W_);
+  branch("Q2", &Q2_);
+  branch("nu", &nu_);
+  branch("x", &x_);
+  branch("y", &y_);
+  branch("epsilon", &epsilon_);
+  branch("R", &R_);
+  branch("t", &t_);
+  branch("xv", &xv_);
+  branch("Q2plusM2", &Q2plusM2_);
+  branch("target_index", &target_index_);
+  branch("photon_index", &photon_index_);
+  branch("scat_index", &scat_index_);
+  branch("leading_index", &leading_index_);
+  branch("recoil_index", &recoil_index_);
 
-  tree()->Branch("rc_W", &rc_W_);
-  tree()->Branch("rc_Q2", &rc_Q2_);
-  tree()->Branch("rc_nu", &rc_nu_);
-  tree()->Branch("rc_x", &rc_x_);
-  tree()->Branch("rc_y", &rc_y_);
-  tree()->Branch("rc_t", &rc_t_);
-  tree()->Branch("rc_xv", &rc_xv_);
-  tree()->Branch("rc_Q2plusM2", &rc_Q2plusM2_);
-  tree()->Branch("rc_photon_index", &rc_photon_index_);
-  tree()->Branch("rc_scat_index", &rc_scat_index_);
-  tree()->Branch("rc_leading_index", &rc_leading_index_);
-  tree()->Branch("rc_recoil_index", &rc_recoil_index_);
+  branch("rc_W", &rc_W_);
+  branch("rc_Q2", &rc_Q2_);
+  branch("rc_nu", &rc_nu_);
+  branch("rc_x", &rc_x_);
+  branch("rc_y", &rc_y_);
+  branch("rc_t", &rc_t_);
+  branch("rc_xv", &rc_xv_);
+  branch("rc_Q2plusM2", &rc_Q2plusM2_);
+  branch("rc_photon_index", &rc_photon_index_);
+  branch("rc_scat_index", &rc_scat_index_);
+  branch("rc_leading_index", &rc_leading_index_);
+  branch("rc_recoil_index", &rc_recoil_index_);
 }
 
 } // namespace lager
@@ -27,6 +27,7 @@
 #include <HepMC3/WriterAscii.h>
 #include <fstream>
 #include <memory>
+#include <vector>
 
 namespace lager {
 
@@ -58,13 +59,53 @@ private:
   initial::photon photon_;
 };
 
+// =============================================================================
+// Block of lA initial states for the batched process generator interface.
+//
+// Besides the initial states, the photon-target kinematics are stored as a
+// structure-of-arrays so the process generators can evaluate their cross
+// section for the full block in vectorizable loops.
+// =============================================================================
+class lA_block : public initial_block<lA_data> {
+public:
+  using base_type = initial_block<lA_data>;
+
+  void clear();
+  void push_back(const lA_data& initial);
+
+  // photon-target kinematics
+  const std::vector<double>& W() const { return W_; }
+  const std::vector<double>& W2() const { return W2_; }
+  const std::vector<double>& Q2() const { return Q2_; }
+  const std::vector<double>& epsilon() const { return epsilon_; }
+  // target mass
+  const std::vector<double>& Mt() const { return Mt_; }
+
+  // full event cross section for a process cross section xs in lane i, i.e.
+  // including the target and photon cross sections (cf. lA_event)
+  double cross_section(const size_t i, const double xs) const {
+    return xs * target_xs_[i] * photon_xs_[i];
+  }
+
+private:
+  std::vector<double> W_;
+  std::vector<double> W2_;
+  std::vector<double> Q2_;
+  std::vector<double> epsilon_;
+  std::vector<double> Mt_;
+  std::vector<double> target_xs_;
+  std::vector<double> photon_xs_;
+};
+
 // =============================================================================
 // full lA event
 // =============================================================================
 class lA_event : public event {
 public:
   lA_event(const lA_event&) = default;
+  lA_event(lA_event&&) = default;
   lA_event& operator=(const lA_event&) = default;
+  lA_event& operator=(lA_event&&) = default;
   explicit lA_event(const double xs = 1., const double w = 1.,
                     const double R = 0., const double epsilon = 0.);
   lA_event(const lA_data& initial, const double xs, const double w = 1.,
@@ -194,9 +235,12 @@ private:
 // =============================================================================
 class lA_out : public event_out {
 public:
-  lA_out(std::shared_ptr<TFile> f, std::unique_ptr<HepMC3::WriterAscii> ohepmc,
-         std::unique_ptr<std::ofstream> ogemc,
-         std::unique_ptr<std::ofstream> osimc, const std::string& name);
+  lA_out(std::shared_ptr<TFile> f, std::unique_ptr<hepmc_out> ohepmc,
+         std::unique_ptr<text_writer> ogemc,
+         std::unique_ptr<text_writer> osimc, const std::string& name,
+         const position& start = {},
+         const particle_layout layout = particle_layout::TPARTICLE,
+         const output_format format = output_format::TTREE);
 
   void push(const lA_event& e);
   void push(const std::vector<lA_event>& e);
@@ -248,6 +292,31 @@ inline lA_data::lA_data(const initial::beam& l, const initial::beam& A,
     , target_{t}
     , photon_{gamma} {}
 
+// =============================================================================
+// LA_BLOCK IMPLEMENTATION
+// =============================================================================
+inline void lA_block::clear() {
+  base_type::clear();
+  W_.clear();
+  W2_.clear();
+  Q2_.clear();
+  epsilon_.clear();
+  Mt_.clear();
+  target_xs_.clear();
+  photon_xs_.clear();
+}
+inline void lA_block::push_back(const lA_data& initial) {
+  base_type::push_back(initial);
+  const auto& gamma = initial.photon();
+  W_.push_back(gamma.W());
+  W2_.push_back(gamma.W2());
+  Q2_.push_back(gamma.Q2());
+  epsilon_.push_back(gamma.epsilon());
+  Mt_.push_back(initial.target().particle().mass());
+  target_xs_.push_back(initial.target().cross_section());
+  photon_xs_.push_back(gamma.cross_section());
+}
+
 // =============================================================================
 // LA_EVENT IMPLEMENTATION
 // =============================================================================
@@ -23,7 +23,7 @@
 namespace lager {
 
 lA_generator::lA_generator(const configuration& cf, const string_path& path,
-                           std::shared_ptr<TRandom> r)
+                           std::shared_ptr<random_engine> r)
     : base_type{cf, path, r}
     , vertex_gen_{FACTORY_CREATE(initial::vertex_generator, conf(), "vertex",
                                  r)}
@@ -41,6 +41,9 @@ lA_generator::lA_generator(const configuration& cf, const string_path& path,
   register_initial(ion_gen_);
   register_initial(target_gen_);
   register_initial(photon_gen_);
+  stage_decay_ = timing().stage("event_builder/decay");
+  stage_detector_ = timing().stage("event_builder/detector");
+  stage_reconstruction_ = timing().stage("event_builder/reconstruction");
 }
 
 lA_data lA_generator::generate_initial() const {
@@ -59,9 +62,18 @@ lA_data lA_generator::generate_initial() const {
 }
 
 void lA_generator::build_event(lA_event& e) const {
-  decay_proc_->process(e);
-  detector_proc_->process(e);
-  rc_proc_->process(e);
+  {
+    scoped_timer t{timing(), stage_decay_, e.process()};
+    decay_proc_->process(e);
+  }
+  {
+    scoped_timer t{timing(), stage_detector_, e.process()};
+    detector_proc_->process(e);
+  }
+  {
+    scoped_timer t{timing(), stage_reconstruction_, e.process()};
+    rc_proc_->process(e);
+  }
 }
 
 } // namespace lager
@@ -31,12 +31,12 @@
 
 namespace lager {
 
-class lA_generator : public event_generator<lA_event, lA_data> {
+class lA_generator : public event_generator<lA_event, lA_data, lA_block> {
 public:
-  using base_type = event_generator<lA_event, lA_data>;
+  using base_type = event_generator<lA_event, lA_data, lA_block>;
 
   lA_generator(const configuration& cf, const string_path& path,
-               std::shared_ptr<TRandom> r);
+               std::shared_ptr<random_engine> r);
 
 protected:
   virtual lA_data generate_initial() const;
@@ -53,6 +53,10 @@ private:
   std::shared_ptr<decay::lA> decay_proc_;
   std::shared_ptr<detector::detector> detector_proc_;
   std::shared_ptr<reconstruction::lA> rc_proc_;
+  // timing stages for the event processors (part of "event_builder")
+  size_t stage_decay_;
+  size_t stage_detector_;
+  size_t stage_reconstruction_;
 };
 
 } // namespace lager
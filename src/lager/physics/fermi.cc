@@ -21,6 +21,8 @@
 
 #include <TMath.h>
 
+#include <mutex>
+
 extern "C" {
 void fermi87_(double& P, int& A, double& res);
 }
@@ -33,7 +35,12 @@ namespace physics {
 double fermi87(double P, int A) {
   double res;
   double P_MeV = P * 1000;
-  fermi87_(P_MeV, A, res);
+  {
+    // the fortran routine uses common blocks and is not re-entrant
+    static std::mutex fortran_mutex;
+    std::lock_guard<std::mutex> lock{fortran_mutex};
+    fermi87_(P_MeV, A, res);
+  }
   res *= 1e9; // MeV^-3 --> GeV^-3
   // Jacobian to go to spherical coordinates, and integrate out theta and phi
   res *= 4 * TMath::Pi() * P * P;
@@ -19,6 +19,7 @@
 
 #include "lA.hh"
 #include <cmath>
+#include <mutex>
 #include <lager/core/particle.hh>
 #include <lager/core/pdg.hh>
 #include <lager/core/stringify.hh>
@@ -30,15 +31,57 @@
 namespace lager {
 namespace decay {
 
+namespace {
+// engine of the generator clone that is calling PHOTOS, set for the duration
+// of radiative_decay_vm::process()
+thread_local random_engine* photos_rng = nullptr;
+double photos_random() { return photos_rng->Rndm(); }
+
+// Pc decay angular distributions according to Wang, PRD92-034022(2015)
+// result from a pol6 fit to a digitized version of figure 6c
+double Pc_wang_52p_ctheta(const double x) {
+  const double x2 = x * x;
+  const double x3 = x2 * x;
+  const double x4 = x3 * x;
+  const double x5 = x4 * x;
+  const double x6 = x5 * x;
+  return .149211 - 0.194418 * x - 0.563191 * x2 + 0.374024 * x3 +
+         0.658942 * x4 + 0.110057 * x5 + 0.0931712 * x6;
+}
+// result from a pol7 fit to a digitized version of figure 5c
+double Pc_wang_52m_ctheta(const double x) {
+  const double x2 = x * x;
+  const double x3 = x2 * x;
+  const double x4 = x3 * x;
+  const double x5 = x4 * x;
+  const double x6 = x5 * x;
+  const double x7 = x6 * x;
+  return 1.31241 - 1.19802 * x + 1.58351 * x2 + 17.1514 * x3 + 20.8306 * x4 -
+         4.43848 * x5 + 2.67151 * x6 + 6.06378 * x7;
+}
+// result from a expo fit to a digitized version of figure 5b
+double Pc_wang_32p_ctheta(const double x) { return exp(-5.944 - x); }
+// result from a pol2 fit to a digitized version of figure 6b
+double Pc_wang_32m_ctheta(const double x) {
+  const double x2 = x * x;
+  return 0.00845846 - 0.0128146 * x + 0.00526053 * x2;
+}
+} // namespace
+
 lA::lA(const configuration& conf, const string_path& path,
-       std::shared_ptr<TRandom> r)
+       std::shared_ptr<random_engine> r)
     : lA::base_type{std::move(r)}
     , vm_decay_plus_{static_cast<pdg_id>(
           -abs(conf.get<int>(path / "vm_decay_lepton_type", 11)))}
     , vm_decay_minus_{static_cast<pdg_id>(
           abs(conf.get<int>(path / "vm_decay_lepton_type", 11)))}
-    , vm_decay_br_{conf.get<double>(path / "vm_branching_ratio", 1)} {
-  LOG_INFO("decay", "VM decays into HENRY WAS HERE!" + vm_decay_plus_.name() +
+    , vm_decay_br_{conf.get<double>(path / "vm_branching_ratio", 1)}
+    , Pc_wang_52p_ctheta_{{-1, 1}, Pc_wang_52p_ctheta}
+    , Pc_wang_52m_ctheta_{{-1, 1}, Pc_wang_52m_ctheta}
+    , Pc_wang_32p_ctheta_{{-1, 1}, Pc_wang_32p_ctheta}
+    , Pc_wang_32m_ctheta_{{-1, 1}, Pc_wang_32m_ctheta} {
+  LOG_INFO("decay", "VM decays into HENRY WAS HERE!" +
+                        std::string(vm_decay_plus_.name()) +
                         vm_decay_minus_.name());
   LOG_INFO("decay",
            "VM Branching ratio set to: " + std::to_string(vm_decay_br_));
@@ -52,7 +95,8 @@ lA::lA(const configuration& conf, const string_path& path,
 
 void lA::process(lA_event& e) const {
   for (int i = 0; i < e.size(); ++i) {
-    LOG_JUNK2("decay::lA", "Considering decay for particle " + e[i].name());
+    LOG_JUNK2("decay::lA", "Considering decay for particle " +
+                               std::string(e[i].name()));
     // we won't decay stable particles
     if (e[i].stable()) {
       LOG_JUNK2("decay::lA", "Particle does not need to be decayed");
@@ -91,7 +135,7 @@ void lA::process(lA_event& e) const {
       LOG_JUNK2("decay::lA", "Pc decay");
       pentaquark_qpq(e, i);
     } else {
-      LOG_DEBUG("decay::lA", "Unstable particle " + e[i].name() +
+      LOG_DEBUG("decay::lA", "Unstable particle " + std::string(e[i].name()) +
                                  ", but no decay path implemented");
     }
   }
@@ -109,7 +153,7 @@ void lA::quarkonium_schc(lA_event& e, const int i) const {
       {vm_decay_minus_.type(), particle::status_code::INFO_PARENT_CM}};
   const double epsilon_R = e.epsilon() * e.R();
   const double r04 = epsilon_R / (1 + epsilon_R);
-  const double phi = rng()->Uniform(0., TMath::TwoPi());
+  const double phi = rng().Uniform(0., TMath::TwoPi());
   const double ctheta = rand_f(
       {-1, 1},
       [=](const double ctheta) {
@@ -126,7 +170,7 @@ void lA::quarkonium_schc(lA_event& e, const int i) const {
 
   e.add_daughter(decay_products, i);
   if (radiative_decay_) {
-    radiative_decay_->process(e, i);
+    radiative_decay_->process(e, i, rng());
   }
 
   // do not store the CM particles
@@ -153,13 +197,13 @@ void lA::quarkonium_hadronic_schc(lA_event& e, const int i) const {
       {vm_decay_minus_.type(), particle::status_code::INFO_PARENT_CM}};
   const double epsilon_R = e.epsilon() * e.R();
   const double r04 = epsilon_R / (1 + epsilon_R);
-  const double phi = rng()->Uniform(0., TMath::TwoPi());
+  const double phi = rng().Uniform(0., TMath::TwoPi());
   
   const double ctheta = rand_f(
       {-1, 1},
       [=](const double ctheta) {
 	//return ((1. - r04) + (3. * r04 - 1) * ctheta * ctheta); Hadronic one, but gives strange results
-	return rng()->Uniform(-1, 1);
+	return rng().Uniform(-1, 1);
 	//return ((1. + r04) + (1. - 3. * r04) * ctheta * ctheta); Leptonic one, but gives NaN for theta?
       },
       2.001);
@@ -175,7 +219,7 @@ void lA::quarkonium_hadronic_schc(lA_event& e, const int i) const {
 
   e.add_daughter(decay_products, i);
   if (radiative_decay_) {
-    radiative_decay_->process(e, i);
+    radiative_decay_->process(e, i, rng());
   }
 
   // do not store the CM particles
@@ -191,10 +235,13 @@ void lA::quarkonium_hadronic_schc(lA_event& e, const int i) const {
  
 radiative_decay_vm::radiative_decay_vm() {
   Photospp::Photos::initialize();
+  // use the lAger engine instead of the PHOTOS internal generator
+  Photospp::Photos::setRandomGenerator(photos_random);
   // 0.5MeV cutoff for a 3GeV J/psi
   Photospp::Photos::setInfraredCutOff(.0005 / 3.);
 }
-void radiative_decay_vm::process(lA_event& e, const int vm_index) {
+void radiative_decay_vm::process(lA_event& e, const int vm_index,
+                                 random_engine& rng) {
   const std::pair<int, int> decay_index = {e[vm_index].daughter_begin(),
                                            e[vm_index].daughter_begin() + 1};
   HepMC::GenEvent evt(20, 1);
@@ -215,8 +262,15 @@ void radiative_decay_vm::process(lA_event& e, const int vm_index) {
           e[decay_index.second].p().X(), e[decay_index.second].p().Y(),
           e[decay_index.second].p().Z(), e[decay_index.second].p().E()),
       e[decay_index.second].type<int>(), 31));
-  Photospp::PhotosHepMCEvent photos_event(&evt);
-  photos_event.process();
+  {
+    // PHOTOS keeps global state, only one thread can use it at a time
+    static std::mutex photos_mutex;
+    std::lock_guard<std::mutex> lock{photos_mutex};
+    photos_rng = &rng;
+    Photospp::PhotosHepMCEvent photos_event(&evt);
+    photos_event.process();
+    photos_rng = nullptr;
+  }
   // did we radiate one (or more) photons?
   if (evt.particles_size() > 3) {
     // then we need to update our event record and add the photon
@@ -243,58 +297,19 @@ void lA::pentaquark_qpq(lA_event& e, const int i) const {
   std::pair<particle, particle> decay_products_cm{
       {pdg_id::J_psi, particle::status_code::INFO_PARENT_CM},
       {pdg_id::p, particle::status_code::INFO_PARENT_CM}};
-  const double phi = rng()->Uniform(0., TMath::TwoPi());
+  const double phi = rng().Uniform(0., TMath::TwoPi());
   double ctheta = -1;
   if (e[i].type() == pdg_id::Pc_wang_52p) {
-    // result from a pol6 fit to a digitized version of figure 6c from
-    // PRD92-034022(2015)
-    ctheta = rand_f(
-        {-1, 1},
-        [](const double x) {
-          const double x2 = x * x;
-          const double x3 = x2 * x;
-          const double x4 = x3 * x;
-          const double x5 = x4 * x;
-          const double x6 = x5 * x;
-          return .149211 - 0.194418 * x - 0.563191 * x2 + 0.374024 * x3 +
-                 0.658942 * x4 + 0.110057 * x5 + 0.0931712 * x6;
-        },
-        0.63);
+    ctheta = rand_f(Pc_wang_52p_ctheta_);
   } else if (e[i].type() == pdg_id::Pc_wang_52m) {
-    // result from a pol7 fit to a digitized version of figure 5c from
-    // PRD92-034022(2015)
-    ctheta = rand_f(
-        {-1, 1},
-        [](const double x) {
-          const double x2 = x * x;
-          const double x3 = x2 * x;
-          const double x4 = x3 * x;
-          const double x5 = x4 * x;
-          const double x6 = x5 * x;
-          const double x7 = x6 * x;
-          return 1.31241 - 1.19802 * x + 1.58351 * x2 + 17.1514 * x3 +
-                 20.8306 * x4 - 4.43848 * x5 + 2.67151 * x6 + 6.06378 * x7;
-        },
-        44.06);
+    ctheta = rand_f(Pc_wang_52m_ctheta_);
   } else if (e[i].type() == pdg_id::Pc_wang_32p) {
-    // result from a expo fit to a digitized version of figure 5b from
-    // PRD92-034022(2015)
-    ctheta = rand_f(
-        {-1, 1}, [](const double x) { return exp(-5.944 - x); }, 0.00713);
+    ctheta = rand_f(Pc_wang_32p_ctheta_);
   } else if (e[i].type() == pdg_id::Pc_wang_32m) {
-    // result from a pol2 fit to a digitized version of figure 6b from
-    // PRD92-034022(2015)
-    ctheta = rand_f(
-        {-1, 1},
-        [](const double x) {
-          const double x2 = x * x;
-          return 0.00845846 - 0.0128146 * x + 0.00526053 * x2;
-        },
-        0.0266);
+    ctheta = rand_f(Pc_wang_32m_ctheta_);
   } else {
     // isotropic decay (flat in cos theta)
-    ctheta = rand_f(
-        {-1, 1}, [](const double x) { return 1.; }, 1.);
+    ctheta = rng().Uniform(-1, 1);
   }
   const double theta = acos(ctheta);
   std::cout << "theta = " << theta << std::endl;
@@ -326,7 +341,7 @@ void lA::quarkonium_radcor_only(lA_event& e, const int i) const {
   // electron or muon BR only
   e.update_weight(vm_decay_br_);
   if (radiative_decay_) {
-    radiative_decay_->process(e, i);
+    radiative_decay_->process(e, i, rng());
   }
   // mark the vm as decayed
   e[i].update_status(particle::status_code::DECAYED_RADCOR_ONLY);
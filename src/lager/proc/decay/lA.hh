@@ -42,13 +42,16 @@ namespace decay {
 class radiative_decay_vm {
 public:
   radiative_decay_vm();
-  void process(lA_event& e, const int vm_index);
+  // PHOTOS draws its random numbers from rng (the engine of the calling
+  // generator clone), so the result only depends on the work unit
+  void process(lA_event& e, const int vm_index, random_engine& rng);
 };
 
 class lA : public decay<lA_event> {
 public:
   using base_type = decay<lA_event>;
-  lA(const configuration&, const string_path&, std::shared_ptr<TRandom> r);
+  lA(const configuration&, const string_path&,
+     std::shared_ptr<random_engine> r);
   virtual void process(lA_event& e) const;
 
 private:
@@ -60,6 +63,11 @@ private:
   const particle vm_decay_plus_;
   const particle vm_decay_minus_;
   const double vm_decay_br_;
+  // tabulated Pc decay angular distributions (cos theta)
+  const inverse_cdf Pc_wang_52p_ctheta_;
+  const inverse_cdf Pc_wang_52m_ctheta_;
+  const inverse_cdf Pc_wang_32p_ctheta_;
+  const inverse_cdf Pc_wang_32m_ctheta_;
   std::unique_ptr<radiative_decay_vm> radiative_decay_;
 };
 
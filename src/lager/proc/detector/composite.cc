@@ -24,7 +24,7 @@ namespace lager {
 namespace detector {
 
 composite::composite(const configuration& cf, const string_path& path,
-                     std::shared_ptr<TRandom> r)
+                     std::shared_ptr<random_engine> r)
     : composite::base_type{r} {
   auto tmp_conf = cf;
   auto& conf = tmp_conf.raw_node(path / "components");
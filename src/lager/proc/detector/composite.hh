@@ -32,7 +32,8 @@ class composite : public detector {
 public:
   using base_type = detector;
 
-  composite(const configuration&, const string_path&, std::shared_ptr<TRandom> r);
+  composite(const configuration&, const string_path&,
+            std::shared_ptr<random_engine> r);
 
   virtual void process(event& e) const {
     for (const auto& det : detectors_) {
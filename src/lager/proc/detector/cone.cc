@@ -35,7 +35,7 @@ namespace lager {
 namespace detector {
 
 cone::cone(const configuration& cf, const string_path& path,
-           std::shared_ptr<TRandom> r)
+           std::shared_ptr<random_engine> r)
     : cone::base_type{r}
     , name_{cf.get<std::string>(path / "name")}
     , id_{cf.get<int>(path / "id", 0)}
@@ -68,13 +68,13 @@ cone::cone(const configuration& cf, const string_path& path,
 
 ROOT::Math::PxPyPzMVector cone::detected_track(const particle& part) const {
   const double p =
-      (p_smear_ > 0) ? rng()->Gaus(part.momentum(), p_smear_ * part.momentum())
+      (p_smear_ > 0) ? rng().Gaus(part.momentum(), p_smear_ * part.momentum())
                      : part.momentum();
   const double theta = (theta_smear_ > 0)
-                           ? rng()->Gaus(part.theta(), theta_smear_)
+                           ? rng().Gaus(part.theta(), theta_smear_)
                            : part.theta();
   const double phi =
-      (phi_smear_ > 0) ? rng()->Gaus(part.phi(), phi_smear_) : part.phi();
+      (phi_smear_ > 0) ? rng().Gaus(part.phi(), phi_smear_) : part.phi();
   const double px = p * sin(theta) * cos(phi);
   const double py = p * sin(theta) * sin(phi);
   const double pz = p * cos(theta);
@@ -98,33 +98,40 @@ void cone::process(event& e) const {
           return part.type<int>() == good_pid;
         })) {
       LOG_JUNK2(name_,
-                "Found matching final state particle " + part.name() +
+                "Found matching final state particle " +
+                    std::string(part.name()) +
                     " (status: " + std::to_string(part.status<int>()) +
                     ", momentum: " + std::to_string(part.momentum()) + ")");
       // check cone cuts
       if (p_.includes(part.momentum())) {
-        LOG_JUNK2(name_, "Momentum cut for " + part.name() + ": SUCCESS");
+        LOG_JUNK2(name_, "Momentum cut for " + std::string(part.name()) +
+                             ": SUCCESS");
         LOG_JUNK2(name_,
                   "True theta: " + std::to_string(part.theta()) +
                       ", phi: " + std::to_string(part.phi()));
         if (theta_.includes(part.theta())) {
-          LOG_JUNK2(name_, "Cone cut for " + part.name() + ": SUCCESS");
-          if (acceptance_ == 1. || rng()->Uniform(0, 1.) < acceptance_) {
+          LOG_JUNK2(name_, "Cone cut for " + std::string(part.name()) +
+                               ": SUCCESS");
+          if (acceptance_ == 1. || rng().Uniform(0, 1.) < acceptance_) {
             LOG_JUNK2(name_,
-                      "Flat acceptance for " + part.name() + ": SUCCESS");
+                      "Flat acceptance for " + std::string(part.name()) +
+                          ": SUCCESS");
             auto detected = detected_track(part);
             e.add_detected(
                 {part,
                  {detected.X(), detected.Y(), detected.Z(), detected.E()},
                  id_});
           } else {
-            LOG_JUNK2(name_, "Flat acceptance for " + part.name() + ": FAILED");
+            LOG_JUNK2(name_, "Flat acceptance for " + std::string(part.name()) +
+                                 ": FAILED");
           }
         } else {
-          LOG_JUNK2(name_, "Cone cut for " + part.name() + ": FAILED");
+          LOG_JUNK2(name_, "Cone cut for " + std::string(part.name()) +
+                               ": FAILED");
         }
       } else {
-        LOG_JUNK2(name_, "Momentum cut for " + part.name() + ": FAILED");
+        LOG_JUNK2(name_, "Momentum cut for " + std::string(part.name()) +
+                             ": FAILED");
       }
     }
   }
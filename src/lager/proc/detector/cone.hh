@@ -34,7 +34,8 @@ class cone : public detector {
 public:
   using base_type = detector;
 
-  cone(const configuration&, const string_path&, std::shared_ptr<TRandom> r);
+  cone(const configuration&, const string_path&,
+       std::shared_ptr<random_engine> r);
 
   virtual void process(event& e) const;
 
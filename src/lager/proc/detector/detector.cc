@@ -25,7 +25,7 @@ namespace detector {
 
 // initialize the factory
 factory<detector, const configuration&, const string_path&,
-        std::shared_ptr<TRandom>>
+        std::shared_ptr<random_engine>>
     detector::factory_instance;
 
 // register our generators
@@ -39,10 +39,10 @@ public:
   using base_type = event_processor<event>;
 
   static factory<detector, const configuration&, const string_path&,
-                 std::shared_ptr<TRandom>>
+                 std::shared_ptr<random_engine>>
       factory_instance;
 
-  detector(std::shared_ptr<TRandom> r) : base_type{std::move(r)} {}
+  detector(std::shared_ptr<random_engine> r) : base_type{std::move(r)} {}
 };
 
 } // namespace detector
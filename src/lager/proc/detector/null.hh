@@ -28,7 +28,8 @@ namespace detector {
 class null : public detector {
 public:
   using base_type = detector;
-  null(const configuration&, const string_path&, std::shared_ptr<TRandom> r)
+  null(const configuration&, const string_path&,
+       std::shared_ptr<random_engine> r)
       : base_type{r} {}
 
   virtual void process(event& e) const;
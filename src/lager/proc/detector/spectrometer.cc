@@ -34,7 +34,7 @@ namespace lager {
 namespace detector {
 
 spectrometer::spectrometer(const configuration& cf, const string_path& path,
-                           std::shared_ptr<TRandom> r)
+                           std::shared_ptr<random_engine> r)
     : spectrometer::base_type{r}
     , name_{cf.get<std::string>(path / "name")}
     , id_{cf.get<int>(path / "id", 0)}
@@ -97,12 +97,12 @@ ROOT::Math::PxPyPzMVector
 spectrometer::detected_track(const particle& part, const double th_in,
                              const double th_out) const {
   const double p =
-      (p_smear_ > 0) ? rng()->Gaus(part.momentum(), p_smear_ * part.momentum())
+      (p_smear_ > 0) ? rng().Gaus(part.momentum(), p_smear_ * part.momentum())
                      : part.momentum();
   const double thx =
-      (th_in_smear_ > 0) ? rng()->Gaus(th_in, th_in_smear_) : th_in;
+      (th_in_smear_ > 0) ? rng().Gaus(th_in, th_in_smear_) : th_in;
   const double thy =
-      (th_out_smear_ > 0) ? rng()->Gaus(th_out, th_out_smear_) : th_out;
+      (th_out_smear_ > 0) ? rng().Gaus(th_out, th_out_smear_) : th_out;
   const double px = p * sin(thx);
   const double py = p * sin(thy);
   const double pz = sqrt(p * p - px * px - py * py);
@@ -128,34 +128,41 @@ void spectrometer::process(event& e) const {
           return part.type<int>() == good_pid;
         })) {
       LOG_JUNK2(name_,
-                "Found matching final state particle " + part.name() +
+                "Found matching final state particle " +
+                    std::string(part.name()) +
                     " (status: " + std::to_string(part.status<int>()) +
                     ", momentum: " + std::to_string(part.momentum()) + ")");
       // check spectrometer cuts
       if (p_.includes(part.momentum())) {
-        LOG_JUNK2(name_, "Momentum cut for " + part.name() + ": SUCCESS");
+        LOG_JUNK2(name_, "Momentum cut for " + std::string(part.name()) +
+                             ": SUCCESS");
         auto[th_in, th_out, pz] = track_th_in_out_pz(part);
         LOG_JUNK2(name_,
                   "True th_in: " + std::to_string(th_in) +
                       ", th_out: " + std::to_string(th_out));
         if (th_in_.includes(th_in) && th_out_.includes(th_out) && pz > 0) {
-          LOG_JUNK2(name_, "Angular box cut for " + part.name() + ": SUCCESS");
-          if (acceptance_ == 1. || rng()->Uniform(0, 1.) < acceptance_) {
+          LOG_JUNK2(name_, "Angular box cut for " + std::string(part.name()) +
+                               ": SUCCESS");
+          if (acceptance_ == 1. || rng().Uniform(0, 1.) < acceptance_) {
             LOG_JUNK2(name_,
-                      "Flat acceptance for " + part.name() + ": SUCCESS");
+                      "Flat acceptance for " + std::string(part.name()) +
+                          ": SUCCESS");
             auto detected = detected_track(part, th_in, th_out);
             e.add_detected(
                 {part,
                  {detected.X(), detected.Y(), detected.Z(), detected.E()},
                  id_});
           } else {
-            LOG_JUNK2(name_, "Flat acceptance for " + part.name() + ": FAILED");
+            LOG_JUNK2(name_, "Flat acceptance for " + std::string(part.name()) +
+                                 ": FAILED");
           }
         } else {
-          LOG_JUNK2(name_, "Angular box cut for " + part.name() + ": FAILED");
+          LOG_JUNK2(name_, "Angular box cut for " + std::string(part.name()) +
+                               ": FAILED");
         }
       } else {
-        LOG_JUNK2(name_, "Momentum cut for " + part.name() + ": FAILED");
+        LOG_JUNK2(name_, "Momentum cut for " + std::string(part.name()) +
+                             ": FAILED");
       }
     }
   }
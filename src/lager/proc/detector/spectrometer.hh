@@ -35,7 +35,7 @@ public:
   using base_type = detector;
 
   spectrometer(const configuration&, const string_path&,
-               std::shared_ptr<TRandom> r);
+               std::shared_ptr<random_engine> r);
 
   virtual void process(event& e) const;
 
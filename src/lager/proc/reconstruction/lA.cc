@@ -37,7 +37,7 @@ bool get_bool(const configuration& conf, const string_path& path) {
 } // namespace
 
 lA::lA(const configuration& conf, const string_path& path,
-       std::shared_ptr<TRandom> r)
+       std::shared_ptr<random_engine> r)
     : lA::base_type{std::move(r)}
     , require_leading_{get_bool(conf, path / "require_leading")}
     , require_scat_{get_bool(conf, path / "require_scat")}
@@ -87,7 +87,7 @@ void lA::process(lA_event& e) const {
         LOG_JUNK2("reconstruction",
                   "Found decay particle from leading particle, "
                   "scanning for the matching particles (particle type : " +
-                      e.leading().name() + ") ");
+                      std::string(e.leading().name()) + ") ");
         // disable enforced number of daughters for VMs, as RC particles are
         // also stored as daughters. For now we implicitly reconstruct using
         // only 2 particles for VMs
@@ -38,7 +38,7 @@ class lA : public reconstruction<lA_event> {
 public:
   using base_type = reconstruction<lA_event>;
   lA(const configuration& conf, const string_path& path,
-           std::shared_ptr<TRandom> r);
+           std::shared_ptr<random_engine> r);
   virtual void process(lA_event& e) const;
 
 private:
@@ -21,12 +21,18 @@
 #include <lager/core/framework.hh>
 #include <lager/core/logger.hh>
 #include <lager/core/progress_meter.hh>
+#include <lager/core/threaded_generator.hh>
+#include <lager/core/threaded_output.hh>
 #include <lager/gen/lA_event.hh>
 #include <lager/gen/lA_generator.hh>
 
-#include <HepMC3/WriterAscii.h>
 #include <TFile.h>
-#include <TRandom3.h>
+#include <TH2D.h>
+#include <TROOT.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <fstream>
 #include <memory>
 
@@ -69,6 +75,139 @@ void write_value_to_file(std::shared_ptr<TFile> ofile, const std::string& name,
   tmp->Write();
 }
 
+// write the time spent in every generation stage as 2D histograms (stage vs.
+// process), with the total time and the number of calls
+void write_timing_to_file(std::shared_ptr<TFile> ofile,
+                          const stage_timing& timing) {
+  const int n_stages = static_cast<int>(timing.n_stages());
+  const int n_proc = timing.max_process() + 2;
+  TH2D* seconds = new TH2D("timing_seconds", "", n_stages, 0, n_stages,
+                           n_proc, -1, n_proc - 1);
+  TH2D* calls = new TH2D("timing_calls", "", n_stages, 0, n_stages, n_proc,
+                         -1, n_proc - 1);
+  for (int i = 0; i < n_stages; ++i) {
+    const char* label = timing.stage_name(i).c_str();
+    seconds->GetXaxis()->SetBinLabel(i + 1, label);
+    calls->GetXaxis()->SetBinLabel(i + 1, label);
+    for (int p = -1; p < n_proc - 1; ++p) {
+      const auto e = timing.get(i, p);
+      seconds->SetBinContent(i + 1, p + 2, e.seconds);
+      calls->SetBinContent(i + 1, p + 2, e.calls);
+    }
+  }
+  for (int p = -1; p < n_proc - 1; ++p) {
+    const std::string label = timing.process_name(p);
+    seconds->GetYaxis()->SetBinLabel(p + 2, label.c_str());
+    calls->GetYaxis()->SetBinLabel(p + 2, label.c_str());
+  }
+  ofile->cd();
+  seconds->Write();
+  calls->Write();
+}
+
+// checkpoint file I/O
+// the statistics are stored with full precision, so a resumed run ends up with
+// exactly the same cross section as an uninterrupted run
+using generator_state = threaded_generator<lA_generator>::state;
+std::string to_string_exact(double d) {
+  char buf[64];
+  snprintf(buf, 64, "%.17g", d);
+  return buf;
+}
+void write_checkpoint(const std::string& fname, const generator_state& gs,
+                      const event_out::position& pos) {
+  ptree pt;
+  pt.put("next_unit", gs.next_unit);
+  pt.put("n_events", gs.n_events);
+  pt.put("volume", to_string_exact(gs.volume));
+  pt.put("stats.n_trials", to_string_exact(gs.stats.n_trials));
+  pt.put("stats.n_events", to_string_exact(gs.stats.n_events));
+  pt.put("stats.n_gen_events", to_string_exact(gs.stats.n_gen_events));
+  pt.put("stats.branching_ratio", to_string_exact(gs.stats.branching_ratio));
+  pt.put("stats.sum_weights", to_string_exact(gs.stats.sum_weights));
+  pt.put("stats.sum_weights2", to_string_exact(gs.stats.sum_weights2));
+  pt.put("stats.n_rejected_initial",
+         to_string_exact(gs.stats.n_rejected_initial));
+  for (size_t i = 0; i < gs.stats.processes.size(); ++i) {
+    const auto& ps = gs.stats.processes[i];
+    const std::string key = "stats.process_" + std::to_string(i);
+    pt.put(key + ".n_trials", to_string_exact(ps.n_trials));
+    pt.put(key + ".n_events", to_string_exact(ps.n_events));
+    pt.put(key + ".sum_weights", to_string_exact(ps.sum_weights));
+    pt.put(key + ".sum_weights2", to_string_exact(ps.sum_weights2));
+    for (size_t j = 0; j < N_REJECTION; ++j) {
+      pt.put(key + ".n_rejected." + REJECTION_NAMES[j],
+             to_string_exact(ps.n_rejected[j]));
+    }
+    pt.put(key + ".n_max_exceeded", to_string_exact(ps.n_max_exceeded));
+  }
+  pt.put("output.index", pos.index);
+  pt.put("output.hepmc", pos.hepmc);
+  pt.put("output.gemc", pos.gemc);
+  pt.put("output.simc", pos.simc);
+  // write to a temporary file first, so a preemption never leaves us with a
+  // partial checkpoint
+  write_json(fname + ".tmp", pt);
+  std::rename((fname + ".tmp").c_str(), fname.c_str());
+  LOG_DEBUG("lager", "Checkpoint written at " + std::to_string(gs.n_events) +
+                         " events");
+}
+void read_checkpoint(const std::string& fname, generator_state& gs,
+                     event_out::position& pos) {
+  tassert(boost::filesystem::exists(fname),
+          "Cannot resume, no checkpoint found: " + fname);
+  ptree pt;
+  read_json(fname, pt);
+  gs.next_unit = pt.get<uint64_t>("next_unit");
+  gs.n_events = pt.get<int64_t>("n_events");
+  gs.volume = std::stod(pt.get<std::string>("volume"));
+  gs.stats.n_trials = std::stod(pt.get<std::string>("stats.n_trials"));
+  gs.stats.n_events = std::stod(pt.get<std::string>("stats.n_events"));
+  gs.stats.n_gen_events = std::stod(pt.get<std::string>("stats.n_gen_events"));
+  gs.stats.branching_ratio =
+      std::stod(pt.get<std::string>("stats.branching_ratio"));
+  gs.stats.sum_weights = std::stod(pt.get<std::string>("stats.sum_weights"));
+  gs.stats.sum_weights2 = std::stod(pt.get<std::string>("stats.sum_weights2"));
+  // the rejection counters are optional (checkpoints from older versions)
+  gs.stats.n_rejected_initial =
+      std::stod(pt.get<std::string>("stats.n_rejected_initial", "0"));
+  for (size_t i = 0;; ++i) {
+    const std::string key = "stats.process_" + std::to_string(i);
+    if (!pt.get_child_optional(key)) {
+      break;
+    }
+    gs.stats.processes.push_back(
+        {std::stod(pt.get<std::string>(key + ".n_trials")),
+         std::stod(pt.get<std::string>(key + ".n_events")),
+         std::stod(pt.get<std::string>(key + ".sum_weights")),
+         std::stod(pt.get<std::string>(key + ".sum_weights2"))});
+    auto& ps = gs.stats.processes.back();
+    for (size_t j = 0; j < N_REJECTION; ++j) {
+      ps.n_rejected[j] = std::stod(pt.get<std::string>(
+          key + ".n_rejected." + REJECTION_NAMES[j], "0"));
+    }
+    ps.n_max_exceeded =
+        std::stod(pt.get<std::string>(key + ".n_max_exceeded", "0"));
+  }
+  pos.index = pt.get<int64_t>("output.index");
+  pos.hepmc = pt.get<int64_t>("output.hepmc");
+  pos.gemc = pt.get<int64_t>("output.gemc");
+  pos.simc = pt.get<int64_t>("output.simc");
+}
+// open a text output file, when resuming we reopen the existing file and drop
+// everything written after the checkpoint
+std::unique_ptr<std::ofstream> open_text_output(const std::string& fname,
+                                                const bool resume,
+                                                const int64_t pos) {
+  if (!resume) {
+    return std::make_unique<std::ofstream>(fname);
+  }
+  tassert(boost::filesystem::exists(fname),
+          "Cannot resume, missing output file: " + fname);
+  boost::filesystem::resize_file(fname, pos);
+  return std::make_unique<std::ofstream>(fname, std::ios::in | std::ios::out);
+}
+
 int run_mc(const configuration& cf, const std::string& output) {
 
   // TODO fix this
@@ -108,64 +247,227 @@ int run_mc(const configuration& cf, const std::string& output) {
 
   LOG_INFO("lager", "HK WAS HERE AGAIN Initializing LAGER for lp-gamma processes");
 
-  // get RNG
-  LOG_INFO("lager",
-           "Initializing the RNG with seed " + cf.get<std::string>("run"));
-  std::shared_ptr<TRandom> r{std::make_shared<TRandom3>()};
-  r->SetSeed(cf.get<int>("run"));
+  // number of worker threads
+  const int run = cf.get<int>("run");
+  const int n_threads = cf.get<int>("threads", 1);
+  tassert(n_threads > 0, "Number of threads should be at least 1");
+  LOG_INFO("lager", "Number of threads: " + std::to_string(n_threads));
+  // write the output in a separate thread (on by default)
+  const bool async_output = cf.get<bool>("async_output", true);
+  if (n_threads > 1 || async_output) {
+    ROOT::EnableThreadSafety();
+  }
+
+  // periodic checkpoints (interval in seconds, 0 to disable), and the
+  // checkpoint to resume from
+  const double checkpoint_interval = cf.get<double>("checkpoint", 0.);
+  const std::string checkpoint_file = output + ".checkpoint.json";
+  const bool resume = cf.get<bool>("resume", false);
+  generator_state start_state;
+  event_out::position start_pos;
+  if (resume) {
+    LOG_INFO("lager", "Resuming from checkpoint " + checkpoint_file);
+    read_checkpoint(checkpoint_file, start_state, start_pos);
+  }
+  if (checkpoint_interval > 0) {
+    LOG_INFO("lager", "Checkpoint interval [s]: " +
+                          std::to_string(checkpoint_interval));
+  }
 
   // make output file and buffer
   LOG_INFO("lager", "Initializing the output buffer");
-  std::shared_ptr<TFile> ofile{
-      std::make_shared<TFile>((output + ".root").c_str(), "recreate")};
+  std::shared_ptr<TFile> ofile{std::make_shared<TFile>(
+      (output + ".root").c_str(), resume ? "update" : "recreate")};
 
-  // check if we want hepmc output as well
-  std::unique_ptr<HepMC3::WriterAscii> ohepmc;
+  // optional on-the-fly compression of the HepMC (ASCII), GEMC and SIMC
+  // outputs
+  const auto text_compression = cf.get<text_writer::compression>(
+      "output_text_compression", text_writer::compression::NONE,
+      text_writer::compression_translator());
+  const int text_compression_level =
+      cf.get<int>("output_text_compression_level", -1);
+  const std::string text_ext = text_writer::extension(text_compression);
+  // check if we want hepmc output as well, in HepMC3 ASCII (default), HepMC2
+  // ASCII or HepMC3 ROOT tree format
+  std::unique_ptr<hepmc_out> ohepmc;
   auto do_hepmc = cf.get_optional<bool>("output_hepmc");
   if (do_hepmc && *do_hepmc) {
     LOG_INFO("lager", "Also outputting text output for HepMC");
-    ohepmc = std::make_unique<HepMC3::WriterAscii>((output + ".hepmc").c_str());
+    const auto hepmc_format = cf.get<hepmc_out::format>(
+        "output_hepmc_format", hepmc_out::format::ASCII,
+        hepmc_out::format_translator());
+    const std::string fname = output + hepmc_out::extension(hepmc_format);
+    if (hepmc_format == hepmc_out::format::ROOT_TREE) {
+      tassert(!resume && checkpoint_interval <= 0,
+              "Checkpoints are not supported with the HepMC ROOT tree output");
+      ohepmc = std::make_unique<hepmc_out>(fname);
+    } else {
+      ohepmc = std::make_unique<hepmc_out>(
+          std::make_unique<text_writer>(
+              open_text_output(fname + text_ext, resume, start_pos.hepmc),
+              text_compression, text_compression_level),
+          hepmc_format);
+    }
   }
   // check if we want gemc output as well
-  std::unique_ptr<std::ofstream> ogemc;
+  std::unique_ptr<text_writer> ogemc;
   auto do_gemc = cf.get_optional<bool>("output_gemc");
   if (do_gemc && *do_gemc) {
     LOG_INFO("lager", "Also outputting text output for GEMC");
-    ogemc = std::make_unique<std::ofstream>(output + ".gemc");
+    ogemc = std::make_unique<text_writer>(
+        open_text_output(output + ".gemc" + text_ext, resume, start_pos.gemc),
+        text_compression, text_compression_level);
   }
   // check if we want simc, in similar vein
-  std::unique_ptr<std::ofstream> osimc;
+  std::unique_ptr<text_writer> osimc;
   auto do_simc = cf.get_optional<bool>("output_simc");
   if (do_simc && *do_simc) {
     LOG_INFO("lager", "Also outputting text output for SIMC");
-    osimc = std::make_unique<std::ofstream>(output + ".simc");
+    osimc = std::make_unique<text_writer>(
+        open_text_output(output + ".simc" + text_ext, resume, start_pos.simc),
+        text_compression, text_compression_level);
+  }
+
+  // output format (TTree or RNTuple), an RNTuple is only complete once it is
+  // committed at the end of the run, so it can not be resumed
+  const auto format = cf.get<event_out::output_format>(
+      "output_format", event_out::output_format::TTREE,
+      event_out::format_translator());
+  const bool rntuple = (format == event_out::output_format::RNTUPLE);
+  if (rntuple) {
+    LOG_INFO("lager", "Writing the events to an RNTuple");
+    tassert(!resume && checkpoint_interval <= 0,
+            "Checkpoints are not supported with the RNTuple output");
+  }
+  // particle layout in the tree: TParticle objects or flat columns (always
+  // flat columns for an RNTuple)
+  const auto layout = cf.get<event_out::particle_layout>(
+      "output_layout",
+      rntuple ? event_out::particle_layout::COLUMNS
+              : event_out::particle_layout::TPARTICLE,
+      event_out::layout_translator());
+  if (layout == event_out::particle_layout::COLUMNS) {
+    LOG_INFO("lager", "Writing the particles as flat columns");
   }
+  // compress the output in parallel with ROOT's implicit multi-threading
+  // (RNTuple pages, or TTree baskets)
+  const int output_threads = cf.get<int>("output_threads", 0);
+  if (output_threads > 0) {
+    LOG_INFO("lager", "Number of output compression threads: " +
+                          std::to_string(output_threads));
+    ROOT::EnableImplicitMT(output_threads);
+  }
+
+  // compression, basket size and cluster size (auto flush) of the ROOT
+  // output, ROOT defaults unless specified
+  event_out::write_settings write_settings;
+  auto compression = cf.get_optional<int>("output_compression",
+                                          event_out::compression_translator());
+  if (compression) {
+    // ROOT's recommended level for the algorithm unless specified
+    const int level =
+        cf.get<int>("output_compression_level",
+                    event_out::default_compression_level(*compression));
+    tassert(level >= 0 && level <= 9,
+            "Compression level should be between 0 and 9");
+    write_settings.compression = *compression * 100 + level;
+    LOG_INFO("lager", "Output compression settings: " +
+                          std::to_string(write_settings.compression));
+    ofile->SetCompressionSettings(write_settings.compression);
+  }
+  write_settings.basket_size = cf.get<int32_t>("output_basket_size", 0);
+  write_settings.cluster_size = cf.get<int64_t>("output_auto_flush", 0);
 
-  lA_out evbuf{ofile, std::move(ohepmc), std::move(ogemc), std::move(osimc),
-               "lAger"};
-  // get event generator
+  threaded_output<lA_out, lA_event> evbuf{
+      async_output, ofile, std::move(ohepmc), std::move(ogemc),
+      std::move(osimc), "lAger", start_pos, layout, format};
+  evbuf.output().configure(write_settings);
+  // with checkpoints, the tree header on disk should only be updated at a
+  // checkpoint, so disable the automatic autosave
+  if (checkpoint_interval > 0) {
+    evbuf.output().tree()->SetAutoSave(0);
+  }
+  // get event generator, each worker thread gets its own generator with its
+  // own RNG. The RNG streams are keyed by the run number and positioned by the
+  // work unit index, so the output does not depend on the number of threads.
   LOG_INFO("lager", "Initializing the event generator");
-  lA_generator gen{cf, "generator", r};
+  LOG_INFO("lager", "Initializing the RNG with key " + std::to_string(run));
+  threaded_generator<lA_generator> gen{n_threads, [&](const int) {
+    auto r = std::make_shared<random_engine>(static_cast<uint32_t>(run));
+    return std::make_unique<lA_generator>(cf, "generator", r);
+  }};
+  if (resume) {
+    gen.resume(start_state);
+  }
+
 
   // init the progress meter with number of requested events
   progress_meter progress{static_cast<size_t>(gen.n_requested())};
 
   // loop over events
   LOG_INFO("lager", "Starting the main generation loop");
-  while (!gen.finished()) {
-    evbuf.push(gen.generate());
+  auto last_checkpoint = std::chrono::steady_clock::now();
+  // the output is traced for the same fraction of batches as the generator
+  const int trace_interval = cf.get<int>("timing/trace_interval", 0);
+  for (int64_t batch = 0; !gen.finished(); ++batch) {
+    evbuf.push(gen.generate(),
+               trace_interval > 0 && batch % trace_interval == 0);
     progress.update(gen.n_events(), gen.n_requested());
+    const auto now = std::chrono::steady_clock::now();
+    if (checkpoint_interval > 0 &&
+        std::chrono::duration<double>(now - last_checkpoint).count() >=
+            checkpoint_interval) {
+      write_checkpoint(checkpoint_file, gen.checkpoint(), evbuf.checkpoint());
+      last_checkpoint = now;
+    }
   }
 
+  // wait for the output thread, before anything else is written to the file
+  evbuf.flush();
   LOG_INFO("lager", "Event generation complete");
+  if (gen.precision_reached()) {
+    LOG_INFO("lager", "Requested cross section precision reached");
+  }
   LOG_INFO("lager", "Total number of generated events: " +
                         std::to_string(gen.n_events()));
   LOG_INFO("lager", "Total accepted cross section [nb]: " +
-                        to_string_exp(gen.cross_section()));
+                        to_string_exp(gen.cross_section()) + " +- " +
+                        to_string_exp(gen.cross_section_error()));
   LOG_INFO("lager", "Partial accepted cross section with BR [nb]: " +
-                        to_string_exp(gen.partial_cross_section()));
+                        to_string_exp(gen.partial_cross_section()) + " +- " +
+                        to_string_exp(gen.partial_cross_section_error()));
+  for (size_t i = 0; i < gen.n_processes(); ++i) {
+    LOG_INFO(gen.process_name(i),
+             "Accepted cross section [nb]: " +
+                 to_string_exp(gen.process_cross_section(i)) + " +- " +
+                 to_string_exp(gen.process_cross_section_error(i)) + " (" +
+                 std::to_string(static_cast<int64_t>(gen.process_n_events(i))) +
+                 " events out of " +
+                 std::to_string(static_cast<int64_t>(gen.process_n_trials(i))) +
+                 " trials)");
+  }
   LOG_INFO("lager",
            " --> Acceptance [%]: " + std::to_string(100 * gen.acceptance()));
+  // rejected trials, per process and rejection reason
+  LOG_INFO("lager", "Trials without a valid initial state: " +
+                        std::to_string(static_cast<int64_t>(
+                            gen.n_rejected_initial())));
+  for (size_t i = 0; i < gen.n_processes(); ++i) {
+    std::string rejected = "Rejected trials:";
+    for (size_t j = 0; j < N_REJECTION; ++j) {
+      rejected += std::string(" ") + REJECTION_NAMES[j] + " " +
+                  std::to_string(static_cast<int64_t>(gen.process_n_rejected(
+                      i, static_cast<rejection>(j))));
+    }
+    LOG_INFO(gen.process_name(i), rejected);
+    if (gen.process_n_max_exceeded(i) > 0) {
+      LOG_WARNING(gen.process_name(i),
+                  "Cross section maximum exceeded in " +
+                      std::to_string(static_cast<int64_t>(
+                          gen.process_n_max_exceeded(i))) +
+                      " trials");
+    }
+  }
   // write generation statistics to file as 1D histograms
   LOG_INFO("lager", "Writing generation statistics to output file");
   write_value_to_file(ofile, "weighted_cross_section",
@@ -173,6 +475,45 @@ int run_mc(const configuration& cf, const std::string& output) {
   write_value_to_file(ofile, "weighted_partial_cross_section",
                       gen.partial_cross_section() * gen.n_events());
   write_value_to_file(ofile, "n_events", gen.n_events());
+  write_value_to_file(ofile, "n_rejected_initial", gen.n_rejected_initial());
+  // uncertainties are stored as (error * n_events)^2, so the combined error
+  // after merging multiple runs (e.g. with hadd) is sqrt(variance) / n_events
+  write_value_to_file(
+      ofile, "weighted_cross_section_variance",
+      std::pow(gen.cross_section_error() * gen.n_events(), 2));
+  write_value_to_file(
+      ofile, "weighted_partial_cross_section_variance",
+      std::pow(gen.partial_cross_section_error() * gen.n_events(), 2));
+  // per-process breakdown, with the same conventions
+  for (size_t i = 0; i < gen.n_processes(); ++i) {
+    const std::string& name = gen.process_name(i);
+    write_value_to_file(ofile, "weighted_cross_section_" + name,
+                        gen.process_cross_section(i) * gen.n_events());
+    write_value_to_file(
+        ofile, "weighted_cross_section_variance_" + name,
+        std::pow(gen.process_cross_section_error(i) * gen.n_events(), 2));
+    write_value_to_file(ofile, "n_events_" + name, gen.process_n_events(i));
+    write_value_to_file(ofile, "n_trials_" + name, gen.process_n_trials(i));
+    for (size_t j = 0; j < N_REJECTION; ++j) {
+      write_value_to_file(
+          ofile, "n_rejected_" + std::string(REJECTION_NAMES[j]) + "_" + name,
+          gen.process_n_rejected(i, static_cast<rejection>(j)));
+    }
+    write_value_to_file(ofile, "n_max_exceeded_" + name,
+                        gen.process_n_max_exceeded(i));
+  }
+
+  // time spent in the different stages (the generator threads are stopped
+  // at this point)
+  stage_timing timing = gen.timing();
+  timing.merge(evbuf.output().timing());
+  timing.report("timing");
+  write_timing_to_file(ofile, timing);
+  if (timing.n_spans() > 0) {
+    LOG_INFO("lager", "Writing timing trace to " + output + ".trace.json");
+    std::ofstream otrace{output + ".trace.json"};
+    timing.write_trace(otrace);
+  }
 
   return 0;
 }
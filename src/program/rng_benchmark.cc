@@ -0,0 +1,142 @@
+// lAger: General Purpose l/A-event Generator
+// Copyright (C) 2016-2021 Sylvester Joosten <sjoosten@anl.gov>
+//
+// This file is part of lAger.
+//
+// lAger is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Shoftware Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// lAger is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with lAger.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+// =============================================================================
+// Micro-benchmark for the random number generation
+//
+// Compares the buffered lager::random_engine (accessed by reference) with the
+// previous TRandom3 path, where every call went through a std::shared_ptr
+// copy and a virtual function call.
+//
+// The Philox4x32-10 implementation is first checked against the known-answer
+// vectors of the reference implementation (Random123), the benchmark returns
+// 1 if they do not match.
+//
+// Usage: rng_benchmark [number of calls, default 1e8]
+// =============================================================================
+
+#include <lager/core/random.hh>
+
+#include <TRandom3.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace {
+
+// the previous generator::rng() returned the shared pointer by value
+class trandom_path {
+public:
+  trandom_path() : rng_{std::make_shared<TRandom3>(1)} {}
+  std::shared_ptr<TRandom> rng() const { return rng_; }
+
+private:
+  std::shared_ptr<TRandom> rng_;
+};
+
+// the current generator::rng() returns a reference to the engine
+class engine_path {
+public:
+  engine_path() : rng_{std::make_shared<lager::random_engine>(1)} {}
+  lager::random_engine& rng() const { return *rng_; }
+
+private:
+  std::shared_ptr<lager::random_engine> rng_;
+};
+
+// time n calls to a function, returns the time per call in ns
+template <class Func> double time_per_call(const long n, Func f) {
+  volatile double sink = 0;
+  double sum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < n; ++i) {
+    sum += f();
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  sink = sum;
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(stop - start).count() / n;
+}
+
+// Philox4x32-10 known-answer test (Random123 kat_vectors)
+bool check_philox() {
+  using counter_type = lager::random_engine::counter_type;
+  using key_type = lager::random_engine::key_type;
+  struct known_answer {
+    counter_type ctr;
+    key_type key;
+    counter_type expected;
+  };
+  const known_answer kat[] = {
+      {{0x00000000, 0x00000000, 0x00000000, 0x00000000},
+       {0x00000000, 0x00000000},
+       {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+      {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+       {0xffffffff, 0xffffffff},
+       {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+      {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+       {0xa4093822, 0x299f31d0},
+       {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}};
+  bool ok = true;
+  for (const auto& k : kat) {
+    const counter_type result = lager::random_engine::philox(k.ctr, k.key);
+    if (result != k.expected) {
+      printf("Philox4x32-10 mismatch: got %08x %08x %08x %08x, expected "
+             "%08x %08x %08x %08x\n",
+             result[0], result[1], result[2], result[3], k.expected[0],
+             k.expected[1], k.expected[2], k.expected[3]);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+void report(const char* what, const double t_old, const double t_new) {
+  printf("%-14s %14.2f %14.2f %10.2fx\n", what, t_old, t_new, t_old / t_new);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const long n = (argc > 1) ? std::atol(argv[1]) : 100000000L;
+  if (!check_philox()) {
+    return 1;
+  }
+  printf("Philox4x32-10 known-answer test: OK\n");
+  trandom_path old_path;
+  engine_path new_path;
+
+  printf("RNG benchmark: %li calls per distribution\n", n);
+  printf("%-14s %14s %14s %11s\n", "distribution", "TRandom3 [ns]",
+         "engine [ns]", "speedup");
+  report("Uniform",
+         time_per_call(n, [&] { return old_path.rng()->Uniform(0., 2.); }),
+         time_per_call(n, [&] { return new_path.rng().Uniform(0., 2.); }));
+  report("Gaus", time_per_call(n, [&] { return old_path.rng()->Gaus(0., 1.); }),
+         time_per_call(n, [&] { return new_path.rng().Gaus(0., 1.); }));
+  report("Exp", time_per_call(n, [&] { return old_path.rng()->Exp(1.); }),
+         time_per_call(n, [&] { return new_path.rng().Exp(1.); }));
+  report("BreitWigner",
+         time_per_call(n,
+                       [&] { return old_path.rng()->BreitWigner(1., 0.1); }),
+         time_per_call(n, [&] { return new_path.rng().BreitWigner(1., 0.1); }));
+  return 0;
+}